@@ -0,0 +1,168 @@
+/**
+ * @file       alloc_test.cpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Checks that the decode path does not allocate per group
+ *
+ * @date      17 October  2026 \n
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#include <unistd.h>
+
+#include "rds.h"
+#include "rds_monitor.hpp"
+#include "rds_stations.hpp"
+#include "rds_stream.hpp"
+
+static const char *helpMessage = R"(
+Usage: rds_alloc_test [--stations N] [--messages N]
+
+Decodes a synthetic capture twice with the stream decoder of rds_decoder
+--stream --correct, once printing messages and once summarizing stations,
+the second time counting the calls of operator new, and fails if the decode
+path allocated per group. The capture starts mid-block and carries bit
+errors, so block sync, error correction, station routing, message assembly
+and printing are all exercised; the printed text goes to /dev/null.
+
+Options:
+  --stations N  Stations in the capture, default 20.
+  --messages N  0A and 2A messages per station, default 50.
+)";
+
+/** Calls of operator new while counting is set. */
+static size_t allocations = 0;
+static bool counting = false;
+
+void *operator new(size_t size) {
+  if (counting) allocations++;
+  void *memory = std::malloc(size ? size : 1);
+  if (!memory) throw std::bad_alloc();
+  return memory;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete[](void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, size_t) noexcept { std::free(memory); }
+
+/**
+ * Decodes the capture like rds_decoder --stream --correct, once printing the
+ * messages and once with --stations.
+ * @param fd The capture, read from its start.
+ * @param table Receives the stations.
+ * @param monitor Follows the block error rate of the message decode.
+ * @return Number of printed messages, or -1 on a read error.
+ */
+static int decode(int fd, StationTable &table, QualityMonitor &monitor) {
+  StreamDecoder messages(FORMAT_ASCII, default_max_bad_blocks, true, nullptr, default_sample_rate, nullptr, &monitor);
+  StreamDecoder stations(FORMAT_ASCII, default_max_bad_blocks, true, &table);
+  if (lseek(fd, 0, SEEK_SET) != 0 || messages.run(fd) == 1) return -1;
+  if (lseek(fd, 0, SEEK_SET) != 0 || stations.run(fd) == 1) return -1;
+  return static_cast<int>(messages.get_messages());
+}
+
+/**
+ * Builds a capture of 0A and 2A messages of several stations.
+ * @param stations Number of stations.
+ * @param messages Messages of each type per station.
+ * @param text Output, the blocks in ASCII, starting mid-block and with bit errors.
+ */
+static void build_capture(unsigned stations, unsigned messages, std::vector<char> &text) {
+  std::vector<uint32_t> blocks;
+  uint32_t message[RDS_2A_BLOCKS];
+  for (unsigned m = 0; m < messages; m++) {
+    for (unsigned s = 0; s < stations; s++) {
+      rds_0a_config config_0a = {static_cast<uint16_t>(0x1000 + s), 5, 1, 0, 1, 170, 105, {'S', 't', 'a', 't', 'i', 'o', 'n', ' '}};
+      config_0a.ps[7] = static_cast<char>('A' + s % 26);
+      size_t count = rds_encode_0a(&config_0a, message, RDS_2A_BLOCKS);
+      blocks.insert(blocks.end(), message, message + count);
+      rds_2a_config config_2a = {static_cast<uint16_t>(0x1000 + s), 5, 1, static_cast<uint8_t>(m % 2), {}};
+      std::memset(config_2a.rt, ' ', sizeof(config_2a.rt));
+      std::snprintf(config_2a.rt, sizeof(config_2a.rt), "Radio text of station %u, message %u\r", s, m);
+      count = rds_encode_2a(&config_2a, message, RDS_2A_BLOCKS);
+      blocks.insert(blocks.end(), message, message + count);
+    }
+  }
+  text.assign(7, '1');
+  for (size_t i = 0; i < blocks.size(); i++) {
+    char bits[26];
+    block_to_ascii(blocks[i], bits);
+    // a burst in every 50th block, within reach of the correction
+    if (i % 50 == 49) {
+      bits[11] ^= 1;
+      bits[12] ^= 1;
+    }
+    text.insert(text.end(), bits, bits + 26);
+  }
+}
+
+/**
+ * Parses a positive number option.
+ * @param value The text.
+ * @param out Output.
+ * @return false if the text is not a number from 1 to 10000.
+ */
+static bool parse_count(const char *value, unsigned &out) {
+  char *end;
+  unsigned long number = std::strtoul(value, &end, 10);
+  if (*value == '\0' || *end != '\0' || number == 0 || number > 10000) return false;
+  out = static_cast<unsigned>(number);
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  unsigned stations = 20;
+  unsigned messages = 50;
+  for (int i = 1; i < argc; i++) {
+    if (!std::strcmp(argv[i], "--stations") && i + 1 < argc && parse_count(argv[i + 1], stations)) {
+      i++;
+    } else if (!std::strcmp(argv[i], "--messages") && i + 1 < argc && parse_count(argv[i + 1], messages)) {
+      i++;
+    } else {
+      std::fputs(helpMessage, stderr);
+      return 1;
+    }
+  }
+
+  std::vector<char> text;
+  build_capture(stations, messages, text);
+  std::FILE *capture = std::tmpfile();
+  if (!capture || std::fwrite(text.data(), 1, text.size(), capture) != text.size() || std::fflush(capture) != 0) {
+    std::printf("Cannot write the capture\n");
+    return 1;
+  }
+  std::ofstream null("/dev/null");
+  // the messages and summaries are formatted as usual and thrown away
+  std::streambuf *console = std::cout.rdbuf(null.rdbuf());
+  StationTable table;
+  QualityMonitor monitor(60, 5, null, null);
+
+  // the first pass grows the station table and creates the metric shard
+  int warm = decode(fileno(capture), table, monitor);
+  counting = true;
+  int decoded = decode(fileno(capture), table, monitor);
+  counting = false;
+  std::cout.rdbuf(console);
+  std::fclose(capture);
+
+  std::printf("Decoded %d messages with %zu allocations\n", decoded, allocations);
+  // each pass loses at most the message in which sync is found
+  if (warm < 0 || decoded + 1 < static_cast<int>(2 * stations * messages) || allocations != 0) {
+    std::printf("FAIL\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,590 @@
+/**
+ * @file       bench.cpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Benchmarks of every stage of the RDS encoder and decoder
+ *
+ * @date      17 October  2026 \n
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "bitstream.hpp"
+#include "common.hpp"
+#include "rds.h"
+#include "rds_cache.hpp"
+#include "rds_stream.hpp"
+#include "rds_sync.hpp"
+
+static const char *helpMessage = R"(
+Usage: rds_bench [--blocks N] [--errors P] [--runs N] [--seed N] [--perf] [--json FILE]
+
+Times each stage of the encoder and decoder on a synthetic corpus of 0A and
+2A messages and prints throughput with percentiles over the runs.
+
+Options:
+  --blocks N   Blocks in the corpus, default 1048576.
+  --errors P   Bit error rate of the received corpus, 0 to 0.5, default 0.
+  --runs N     Timed runs of every stage, default 11.
+  --seed N     Seed of the corpus, default 1.
+  --perf       Also count cycles, instructions and branch misses through
+               perf_event_open (Linux, needs perf_event_paranoid <= 2).
+  --json FILE  Also write the results as JSON, - for standard output.
+)";
+
+const uint32_t offsets[] = {offset_A, offset_B, offset_C, offset_D};
+
+/* Settings of the benchmark run */
+struct Options {
+  size_t blocks;     /**< Blocks in the corpus */
+  double error_rate; /**< Probability of a flipped bit in the received corpus */
+  unsigned runs;     /**< Timed runs of every stage */
+  uint32_t seed;     /**< Seed of the pseudo-random corpus */
+  bool perf;         /**< Read hardware counters */
+  std::string json;  /**< Path of the JSON report, empty for none */
+};
+
+/* Hardware counters of one stage, summed over its runs */
+struct Counters {
+  uint64_t cycles;        /**< CPU cycles */
+  uint64_t instructions;  /**< Retired instructions */
+  uint64_t branch_misses; /**< Mispredicted branches */
+};
+
+/* Measurements of one stage */
+struct Result {
+  std::string name;             /**< Name of the stage */
+  size_t blocks;                /**< Blocks processed per run */
+  std::vector<double> seconds;  /**< Duration of every run, sorted */
+  bool has_counters;            /**< Whether counters holds values */
+  Counters counters;            /**< Hardware counters of all runs */
+};
+
+/* Synthetic transmission of whole 0A and 2A messages */
+struct Corpus {
+  std::vector<rds_0a_config> ps;    /**< Settings of the 0A messages */
+  std::vector<rds_2a_config> rt;    /**< Settings of the 2A messages */
+  std::vector<uint32_t> blocks;     /**< Transmitted blocks */
+  std::vector<size_t> starts_0A;    /**< Index of the first block of every 0A message */
+  std::vector<size_t> starts_2A;    /**< Index of the first block of every 2A message */
+  std::vector<uint32_t> received;   /**< Blocks with bit errors */
+  std::string text;                 /**< Received blocks as an ASCII bitstream */
+};
+
+/**
+ * Returns the next pseudo-random number, fixed by the seed for comparable runs.
+ * @param state State of the generator.
+ */
+static uint32_t next_random(uint32_t &state) {
+  state = state * 1664525 + 1013904223;
+  return state;
+}
+
+/**
+ * Returns a pseudo-random number uniform in (0, 1].
+ * @param state State of the generator.
+ */
+static double next_uniform(uint32_t &state) { return (static_cast<double>(next_random(state) >> 8) + 1) / 16777216.0; }
+
+/**
+ * Fills a text field with random letters, digits and spaces.
+ * @param text Output.
+ * @param length Number of characters.
+ * @param state State of the generator.
+ */
+static void random_text(char *text, size_t length, uint32_t &state) {
+  static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789 ";
+  for (size_t i = 0; i < length; i++) text[i] = alphabet[(next_random(state) >> 16) % (sizeof(alphabet) - 1)];
+}
+
+/**
+ * Builds a corpus of alternating 0A and 2A messages of random stations, then
+ * flips bits of a copy at the given rate. The gaps between flipped bits are
+ * drawn from the geometric distribution, so low rates cost nothing per bit.
+ * @param options Size, error rate and seed.
+ * @param corpus Output.
+ */
+static void build_corpus(const Options &options, Corpus &corpus) {
+  uint32_t state = options.seed;
+  while (corpus.blocks.size() < options.blocks) {
+    uint32_t blocks[RDS_2A_BLOCKS];
+    if (corpus.ps.size() <= corpus.rt.size()) {
+      rds_0a_config config{};
+      config.pi = static_cast<uint16_t>(next_random(state) >> 16);
+      config.pty = static_cast<uint8_t>((next_random(state) >> 16) % 32);
+      config.tp = static_cast<uint8_t>((next_random(state) >> 16) & 1);
+      config.ms = static_cast<uint8_t>((next_random(state) >> 16) & 1);
+      config.ta = static_cast<uint8_t>((next_random(state) >> 16) & 1);
+      config.af1 = static_cast<uint8_t>(1 + (next_random(state) >> 16) % 204);
+      config.af2 = static_cast<uint8_t>(1 + (next_random(state) >> 16) % 204);
+      random_text(config.ps, RDS_PS_LENGTH, state);
+      corpus.starts_0A.push_back(corpus.blocks.size());
+      corpus.ps.push_back(config);
+      size_t count = rds_encode_0a(&config, blocks, RDS_2A_BLOCKS);
+      corpus.blocks.insert(corpus.blocks.end(), blocks, blocks + count);
+    } else {
+      rds_2a_config config{};
+      config.pi = static_cast<uint16_t>(next_random(state) >> 16);
+      config.pty = static_cast<uint8_t>((next_random(state) >> 16) % 32);
+      config.tp = static_cast<uint8_t>((next_random(state) >> 16) & 1);
+      config.ab = static_cast<uint8_t>((next_random(state) >> 16) & 1);
+      random_text(config.rt, RDS_RT_LENGTH, state);
+      corpus.starts_2A.push_back(corpus.blocks.size());
+      corpus.rt.push_back(config);
+      size_t count = rds_encode_2a(&config, blocks, RDS_2A_BLOCKS);
+      corpus.blocks.insert(corpus.blocks.end(), blocks, blocks + count);
+    }
+  }
+
+  corpus.received = corpus.blocks;
+  if (options.error_rate > 0) {
+    uint64_t total = static_cast<uint64_t>(corpus.received.size()) * RDS_BLOCK_BITS;
+    double scale = options.error_rate < 1 ? 1 / std::log1p(-options.error_rate) : 0;
+    for (uint64_t bit = static_cast<uint64_t>(std::log(next_uniform(state)) * scale); bit < total;
+         bit += 1 + static_cast<uint64_t>(std::log(next_uniform(state)) * scale)) {
+      corpus.received[bit / RDS_BLOCK_BITS] ^= 1u << (RDS_BLOCK_BITS - 1 - bit % RDS_BLOCK_BITS);
+    }
+  }
+
+  corpus.text.resize(corpus.received.size() * RDS_BLOCK_BITS);
+  rds_blocks_to_ascii(corpus.received.data(), corpus.received.size(), &corpus.text[0], corpus.text.size());
+}
+
+/**
+ * Hardware counters of the calling thread in one perf_event_open group, so
+ * all three count over exactly the same instructions. Only user space is
+ * counted.
+ */
+class PerfCounters {
+public:
+  /** Opens the counters, see is_available(). */
+  PerfCounters() : fds{-1, -1, -1} {
+#ifdef __linux__
+    const uint64_t configs[] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES};
+    for (int i = 0; i < 3; i++) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = configs[i];
+      attr.disabled = i == 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+      fds[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds[0], 0));
+      if (fds[i] < 0) return;
+    }
+#endif
+  }
+
+  ~PerfCounters() {
+    for (int fd : fds) {
+      if (fd >= 0) close(fd);
+    }
+  }
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  /** Returns true if every counter could be opened. */
+  bool is_available() const { return fds[2] >= 0; }
+
+  /** Resets and starts the counters. */
+  void start() {
+#ifdef __linux__
+    ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+  }
+
+  /**
+   * Stops the counters and adds their values.
+   * @param counters The sums.
+   */
+  void stop(Counters &counters) {
+#ifdef __linux__
+    ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    uint64_t values[4] = {};
+    if (read(fds[0], values, sizeof(values)) != static_cast<ssize_t>(sizeof(values))) return;
+    counters.cycles += values[1];
+    counters.instructions += values[2];
+    counters.branch_misses += values[3];
+#else
+    (void)counters;
+#endif
+  }
+
+private:
+  int fds[3]; /**< Cycles (the group leader), instructions, branch misses */
+};
+
+/**
+ * Times a stage: one untimed run to warm up the caches, then the timed runs.
+ * @param name Name of the stage.
+ * @param blocks Blocks processed per run.
+ * @param options Number of runs.
+ * @param perf Counters, used if available and requested.
+ * @param stage The stage, returns a value that is kept from being optimized out.
+ * @return The measurements.
+ */
+template <typename Stage> static Result measure(const char *name, size_t blocks, const Options &options, PerfCounters &perf, Stage stage) {
+  Result result{name, blocks, {}, options.perf && perf.is_available(), {0, 0, 0}};
+  volatile uint32_t sink = stage();
+  for (unsigned run = 0; run < options.runs; run++) {
+    if (result.has_counters) perf.start();
+    auto start = std::chrono::steady_clock::now();
+    sink = stage();
+    auto end = std::chrono::steady_clock::now();
+    if (result.has_counters) perf.stop(result.counters);
+    result.seconds.push_back(std::chrono::duration<double>(end - start).count());
+  }
+  (void)sink;
+  std::sort(result.seconds.begin(), result.seconds.end());
+  return result;
+}
+
+/**
+ * Returns a percentile of the sorted run durations, nearest rank.
+ * @param seconds The durations, sorted.
+ * @param percent The percentile, 0 to 100.
+ */
+static double percentile(const std::vector<double> &seconds, double percent) {
+  size_t rank = static_cast<size_t>(std::ceil(percent / 100 * static_cast<double>(seconds.size())));
+  return seconds[std::min(seconds.size() - 1, rank ? rank - 1 : 0)];
+}
+
+/**
+ * Checks crc() against crc_reference() for every 16-bit information word
+ * and every offset word.
+ * @return Number of mismatching inputs.
+ */
+static unsigned verify_crc() {
+  unsigned mismatches = 0;
+  for (uint32_t offset : offsets) {
+    for (uint32_t info = 0; info < (1 << 16); info++) {
+      uint32_t value = info << 10;
+      if (crc(value, offset) != crc_reference(value, offset)) mismatches++;
+    }
+  }
+  return mismatches;
+}
+
+/**
+ * Offset identification by trying every offset word in turn, as the decoder
+ * did before the syndrome table.
+ * @param block The received block.
+ * @return Position of the block in its group, -1 if no offset matches.
+ */
+static int trial_block_addr(uint32_t block) {
+  for (int i = 0; i < 4; i++) {
+    if (crc(block & (block_mask ^ 0x3FF), offsets[i]) == (block & 0x3FF)) return i;
+  }
+  return -1;
+}
+
+/**
+ * Per-character conversion of an aligned ASCII bitstream into blocks, as
+ * the decoder did before the vectorized parser.
+ * @param text The characters.
+ * @param blocks Output blocks.
+ * @return false if an invalid character was found.
+ */
+static bool scalar_ascii_blocks(const std::string &text, std::vector<uint32_t> &blocks) {
+  for (size_t i = 0; i < text.size() / 26; i++) {
+    uint32_t value = 0;
+    for (size_t b = 0; b < 26; b++) {
+      char c = text[i * 26 + b];
+      if (c != '0' && c != '1') return false;
+      value = (value << 1) | (c == '1');
+    }
+    blocks[i] = value;
+  }
+  return true;
+}
+
+/**
+ * Prints the results as a table. MB/s counts the 26 characters a block
+ * takes in the ASCII bitstream, whatever the stage reads or writes.
+ * @param results The stages.
+ */
+static void print_table(const std::vector<Result> &results) {
+  bool counters = false;
+  for (const Result &result : results) counters |= result.has_counters;
+  std::printf("%-16s %12s %10s %9s %9s %9s", "stage", "blocks/s", "MB/s", "p10 ns", "p50 ns", "p90 ns");
+  if (counters) std::printf(" %9s %9s %9s", "cycles", "IPC", "br-miss");
+  std::printf("\n");
+
+  for (const Result &result : results) {
+    double blocks = static_cast<double>(result.blocks);
+    double median = percentile(result.seconds, 50);
+    std::printf("%-16s %12.4g %10.2f %9.2f %9.2f %9.2f", result.name.c_str(), blocks / median, blocks * RDS_BLOCK_BITS / median / 1e6,
+                percentile(result.seconds, 10) / blocks * 1e9, median / blocks * 1e9, percentile(result.seconds, 90) / blocks * 1e9);
+    if (result.has_counters) {
+      double total = blocks * static_cast<double>(result.seconds.size());
+      std::printf(" %9.2f %9.2f %9.4f", static_cast<double>(result.counters.cycles) / total,
+                  static_cast<double>(result.counters.instructions) / static_cast<double>(std::max<uint64_t>(result.counters.cycles, 1)),
+                  static_cast<double>(result.counters.branch_misses) / total);
+    }
+    std::printf("\n");
+  }
+}
+
+/**
+ * Writes the options and results as JSON, one object per stage with times
+ * per block in nanoseconds.
+ * @param out The file.
+ * @param options The options.
+ * @param results The stages.
+ */
+static void write_json(FILE *out, const Options &options, const std::vector<Result> &results) {
+  std::fprintf(out, "{\n  \"blocks\": %zu,\n  \"error_rate\": %g,\n  \"runs\": %u,\n  \"seed\": %u,\n  \"stages\": [", options.blocks,
+               options.error_rate, options.runs, options.seed);
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result &result = results[i];
+    double blocks = static_cast<double>(result.blocks);
+    double median = percentile(result.seconds, 50);
+    std::fprintf(out, "%s\n    {\"name\": \"%s\", \"blocks\": %zu, \"blocks_per_s\": %.6g, \"mb_per_s\": %.6g", i ? "," : "",
+                 result.name.c_str(), result.blocks, blocks / median, blocks * RDS_BLOCK_BITS / median / 1e6);
+    std::fprintf(out, ", \"ns_per_block\": {\"min\": %.4g, \"p10\": %.4g, \"p50\": %.4g, \"p90\": %.4g, \"p99\": %.4g, \"max\": %.4g}",
+                 result.seconds.front() / blocks * 1e9, percentile(result.seconds, 10) / blocks * 1e9, median / blocks * 1e9,
+                 percentile(result.seconds, 90) / blocks * 1e9, percentile(result.seconds, 99) / blocks * 1e9,
+                 result.seconds.back() / blocks * 1e9);
+    if (result.has_counters) {
+      double total = blocks * static_cast<double>(result.seconds.size());
+      std::fprintf(out, ", \"cycles_per_block\": %.4g, \"instructions_per_block\": %.4g, \"branch_misses_per_block\": %.4g",
+                   static_cast<double>(result.counters.cycles) / total, static_cast<double>(result.counters.instructions) / total,
+                   static_cast<double>(result.counters.branch_misses) / total);
+    }
+    std::fprintf(out, "}");
+  }
+  std::fprintf(out, "\n  ]\n}\n");
+}
+
+/**
+ * Parses the command line.
+ * @param argc Number of arguments.
+ * @param argv The arguments.
+ * @param options Output.
+ * @return false if an argument is invalid.
+ */
+static bool parse_options(int argc, char *argv[], Options &options) {
+  options = Options{1u << 20, 0, 11, 1, false, ""};
+  for (int i = 1; i < argc; i++) {
+    std::string flag = argv[i];
+    std::string value = i + 1 < argc ? argv[i + 1] : "";
+    bool numeric = !value.empty() && value.size() <= 9 && value.find_first_not_of("0123456789") == std::string::npos;
+    if (flag == "--perf") {
+      options.perf = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      std::printf("Invalid flag: %s\n", flag.c_str());
+      return false;
+    }
+    i++;
+    if (flag == "--blocks" && numeric && std::stoul(value) >= RDS_2A_BLOCKS) {
+      options.blocks = std::stoul(value);
+    } else if (flag == "--runs" && numeric && std::stoul(value) > 0) {
+      options.runs = static_cast<unsigned>(std::stoul(value));
+    } else if (flag == "--seed" && numeric) {
+      options.seed = static_cast<uint32_t>(std::stoul(value));
+    } else if (flag == "--errors" && !value.empty() && value.find_first_not_of("0123456789.e-") == std::string::npos &&
+               std::atof(value.c_str()) >= 0 && std::atof(value.c_str()) <= 0.5) {
+      options.error_rate = std::atof(value.c_str());
+    } else if (flag == "--json") {
+      options.json = value;
+    } else if (flag == "--blocks" || flag == "--runs" || flag == "--seed" || flag == "--errors") {
+      std::printf("Invalid value for %s: %s\n", flag.c_str(), value.c_str());
+      return false;
+    } else {
+      std::printf("Invalid flag: %s\n", flag.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  Options options;
+  if (!parse_options(argc, argv, options)) {
+    std::printf("%s", helpMessage);
+    return 1;
+  }
+
+  unsigned mismatches = verify_crc();
+  if (mismatches != 0) {
+    std::printf("crc() differs from crc_reference() for %u inputs\n", mismatches);
+    return 1;
+  }
+
+  Corpus corpus;
+  build_corpus(options, corpus);
+  size_t count = corpus.received.size();
+  size_t errors = 0;
+  for (size_t i = 0; i < count; i++) errors += static_cast<size_t>(__builtin_popcount(corpus.blocks[i] ^ corpus.received[i]));
+  std::printf("%zu blocks (%zu 0A and %zu 2A messages), %zu bit errors, %u runs\n", count, corpus.ps.size(), corpus.rt.size(), errors,
+              options.runs);
+
+  PerfCounters perf;
+  if (options.perf && !perf.is_available()) std::printf("perf_event_open failed, hardware counters are left out\n");
+
+  std::vector<Result> results;
+  const std::vector<uint32_t> &received = corpus.received;
+
+  // checkwords of the information words, as the encoder computes them
+  std::vector<uint32_t> words(count);
+  for (size_t i = 0; i < count; i++) words[i] = corpus.blocks[i] & (block_mask ^ 0x3FF);
+  results.push_back(measure("crc_reference", count, options, perf, [&]() {
+    uint32_t acc = 0;
+    for (size_t i = 0; i < count; i++) acc ^= crc_reference(words[i], offsets[i & 3]);
+    return acc;
+  }));
+  results.push_back(measure("crc", count, options, perf, [&]() {
+    uint32_t acc = 0;
+    for (size_t i = 0; i < count; i++) acc ^= crc(words[i], offsets[i & 3]);
+    return acc;
+  }));
+
+  // offset identification of the received blocks
+  results.push_back(measure("block_addr_trial", count, options, perf, [&]() {
+    uint32_t acc = 0;
+    for (uint32_t block : received) acc += static_cast<uint32_t>(trial_block_addr(block));
+    return acc;
+  }));
+  results.push_back(measure("get_block_addr", count, options, perf, [&]() {
+    uint32_t acc = 0;
+    for (uint32_t block : received) acc += static_cast<uint32_t>(get_block_addr(block));
+    return acc;
+  }));
+
+  // the -b argument of the decoder
+  std::vector<uint32_t> scalar(count);
+  std::vector<uint32_t> vectorized(count);
+  results.push_back(measure("ascii_scalar", count, options, perf, [&]() { return static_cast<uint32_t>(scalar_ascii_blocks(corpus.text, scalar)); }));
+  results.push_back(measure("ascii_parse", count, options, perf, [&]() {
+    return static_cast<uint32_t>(parse_ascii_blocks(corpus.text.data(), corpus.text.size(), vectorized.data()));
+  }));
+  if (scalar != vectorized || vectorized != received) {
+    std::printf("parse_ascii_blocks() differs from the per-character parser\n");
+    return 1;
+  }
+
+  // rds_sort_group() with correction, as errors are expected, and the assembly of the sorted groups
+  results.push_back(measure("sort_groups", count, options, perf, [&]() {
+    rds_assembler assemblers[2];
+    rds_assembler_init(&assemblers[0]);
+    rds_assembler_init(&assemblers[1]);
+    uint32_t sorted[RDS_GROUP_BLOCKS];
+    uint32_t messages = 0;
+    for (size_t i = 0; i + RDS_GROUP_BLOCKS <= count; i += RDS_GROUP_BLOCKS) {
+      if (rds_sort_group(received.data() + i, 1, sorted, nullptr) != RDS_OK) continue;
+      GroupType type = get_group(sorted[1]);
+      if (type == UNKNOWN) continue;
+      rds_assembler &assembler = assemblers[type];
+      rds_assembler_push(&assembler, sorted);
+      if (!rds_assembler_complete(&assembler)) continue;
+      messages++;
+      rds_assembler_init(&assembler);
+    }
+    return messages;
+  }));
+
+  // the stream decoder, bit by bit until it is synchronized and then block by block
+  results.push_back(measure("synchronize", count, options, perf, [&]() {
+    BlockSynchronizer synchronizer(default_max_bad_blocks, true);
+    BitReader reader;
+    uint32_t groups = 0;
+    for (uint32_t block : received) {
+      reader.push(block, RDS_BLOCK_BITS);
+      while (reader.available() > 0) {
+        bool done;
+        if (synchronizer.is_synced()) {
+          if (reader.available() < RDS_BLOCK_BITS) break;
+          done = synchronizer.push_block(reader.take(RDS_BLOCK_BITS));
+        } else {
+          done = synchronizer.push_bit(reader.take(1));
+        }
+        groups += done && synchronizer.group_complete();
+      }
+    }
+    return groups;
+  }));
+
+  // Group0A::parse() and Group2A::parse() of the stream decoder, after collecting the groups of a message
+  auto parse = [&](const std::vector<size_t> &starts, size_t blocks) {
+    return [&starts, blocks, &corpus]() {
+      uint32_t acc = 0;
+      for (size_t start : starts) {
+        rds_assembler assembler;
+        rds_assembler_init(&assembler);
+        for (size_t i = 0; i < blocks; i += RDS_GROUP_BLOCKS) rds_assembler_push(&assembler, corpus.blocks.data() + start + i);
+        if (blocks == RDS_0A_BLOCKS) {
+          acc += static_cast<uint32_t>(Group0A(assembler).parse());
+        } else {
+          acc += static_cast<uint32_t>(Group2A(assembler).parse());
+        }
+      }
+      return acc;
+    };
+  };
+  results.push_back(measure("parse_0A", corpus.starts_0A.size() * RDS_0A_BLOCKS, options, perf, parse(corpus.starts_0A, RDS_0A_BLOCKS)));
+  results.push_back(measure("parse_2A", corpus.starts_2A.size() * RDS_2A_BLOCKS, options, perf, parse(corpus.starts_2A, RDS_2A_BLOCKS)));
+
+  // print_bits() of the encoder, every message of a new station through the cache into the writer
+  int null_fd = open("/dev/null", O_WRONLY);
+  if (null_fd < 0) {
+    std::printf("Cannot open /dev/null\n");
+    return 1;
+  }
+  results.push_back(measure("print_bits_0A", corpus.ps.size() * RDS_0A_BLOCKS, options, perf, [&]() {
+    BlockCache cache;
+    BlockWriter writer(FORMAT_ASCII, null_fd);
+    for (const rds_0a_config &config : corpus.ps) {
+      cache.update_0a(config);
+      const uint32_t *blocks = cache.blocks_0a();
+      for (size_t i = 0; i < RDS_0A_BLOCKS; i++) writer.write_block(blocks[i]);
+    }
+    return static_cast<uint32_t>(cache.get_encoded());
+  }));
+  results.push_back(measure("print_bits_2A", corpus.rt.size() * RDS_2A_BLOCKS, options, perf, [&]() {
+    BlockCache cache;
+    BlockWriter writer(FORMAT_ASCII, null_fd);
+    for (const rds_2a_config &config : corpus.rt) {
+      cache.update_2a(config);
+      const uint32_t *blocks = cache.blocks_2a();
+      for (size_t i = 0; i < cache.segments_2a() * 4u; i++) writer.write_block(blocks[i]);
+    }
+    return static_cast<uint32_t>(cache.get_encoded());
+  }));
+  close(null_fd);
+
+  print_table(results);
+  if (options.json.empty()) return 0;
+  FILE *out = options.json == "-" ? stdout : std::fopen(options.json.c_str(), "w");
+  if (!out) {
+    std::printf("Cannot write %s\n", options.json.c_str());
+    return 1;
+  }
+  write_json(out, options, results);
+  if (out != stdout) std::fclose(out);
+  return 0;
+}
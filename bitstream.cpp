@@ -0,0 +1,312 @@
+/**
+ * @file       bitstream.cpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Conversion of RDS blocks to and from the ASCII and packed
+ *            binary bitstream formats
+ *
+ * @date      17 October  2026 \n
+ */
+
+#include "bitstream.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RDS_X86 1
+#endif
+
+int parse_format(const std::string &name, BitFormat &format) {
+  if (name == "ascii") {
+    format = FORMAT_ASCII;
+  } else if (name == "packed") {
+    format = FORMAT_PACKED;
+  } else if (name == "wav") {
+    format = FORMAT_WAV;
+  } else if (name == "f32") {
+    format = FORMAT_F32;
+  } else if (name == "cu8") {
+    format = FORMAT_CU8;
+  } else if (name == "cs16") {
+    format = FORMAT_CS16;
+  } else if (name == "cf32") {
+    format = FORMAT_CF32;
+  } else {
+    return -1;
+  }
+  return 0;
+}
+
+bool is_signal_format(BitFormat format) { return format != FORMAT_ASCII && format != FORMAT_PACKED; }
+
+bool is_iq_format(BitFormat format) { return format == FORMAT_CU8 || format == FORMAT_CS16 || format == FORMAT_CF32; }
+
+size_t sample_size(BitFormat format) {
+  switch (format) {
+  case FORMAT_WAV:
+    return sizeof(int16_t);
+  case FORMAT_F32:
+    return sizeof(float);
+  case FORMAT_CU8:
+    return 2 * sizeof(uint8_t);
+  case FORMAT_CS16:
+    return 2 * sizeof(int16_t);
+  case FORMAT_CF32:
+    return 2 * sizeof(float);
+  default:
+    return 0;
+  }
+}
+
+/**
+ * Reverses the order of bits in a word, movemask puts the first character
+ * in the least significant bit.
+ * @param x The word.
+ * @return The word with bit 0 swapped with bit 31 and so on.
+ */
+static inline uint32_t reverse_bits(uint32_t x) {
+  x = ((x >> 1) & 0x55555555) | ((x & 0x55555555) << 1);
+  x = ((x >> 2) & 0x33333333) | ((x & 0x33333333) << 2);
+  x = ((x >> 4) & 0x0F0F0F0F) | ((x & 0x0F0F0F0F) << 4);
+  return __builtin_bswap32(x);
+}
+
+size_t scan_ascii_bits_scalar(const char *text, size_t length, uint32_t *words) {
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    uint32_t word = 0;
+    for (size_t b = 0; b < 32; b++) {
+      char c = text[i + b];
+      if (c != '0' && c != '1') return i;
+      word = (word << 1) | (c == '1');
+    }
+    *words++ = word;
+  }
+  return i;
+}
+
+#ifdef RDS_X86
+static size_t scan_ascii_bits_sse2(const char *text, size_t length, uint32_t *words) {
+  const __m128i zero = _mm_set1_epi8('0');
+  const __m128i one = _mm_set1_epi8('1');
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i + 16));
+    uint32_t ones = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(lo, one))) |
+                    static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(hi, one))) << 16;
+    uint32_t zeros = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(lo, zero))) |
+                     static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(hi, zero))) << 16;
+    if ((ones | zeros) != 0xFFFFFFFF) return i;
+    *words++ = reverse_bits(ones);
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) static size_t scan_ascii_bits_avx2(const char *text, size_t length, uint32_t *words) {
+  const __m256i zero = _mm256_set1_epi8('0');
+  const __m256i one = _mm256_set1_epi8('1');
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + i));
+    uint32_t ones = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, one)));
+    uint32_t zeros = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, zero)));
+    if ((ones | zeros) != 0xFFFFFFFF) return i;
+    *words++ = reverse_bits(ones);
+  }
+  return i;
+}
+#endif
+
+/**
+ * Picks the widest conversion the CPU supports.
+ * @return The conversion function.
+ */
+static size_t (*select_scan_ascii_bits())(const char *, size_t, uint32_t *) {
+#ifdef RDS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return scan_ascii_bits_avx2;
+  return scan_ascii_bits_sse2;
+#else
+  return scan_ascii_bits_scalar;
+#endif
+}
+
+static size_t (*const scan_ascii_bits_impl)(const char *, size_t, uint32_t *) = select_scan_ascii_bits();
+
+size_t scan_ascii_bits(const char *text, size_t length, uint32_t *words) { return scan_ascii_bits_impl(text, length, words); }
+
+size_t parse_ascii_blocks(const char *text, size_t length, uint32_t *blocks) {
+  uint32_t words[64];
+  BitReader reader;
+  size_t i = 0;
+  while (i < length) {
+    // vectorized part, a window at a time so words stays on the stack
+    size_t window = std::min(length - i, sizeof(words) / sizeof(words[0]) * 32);
+    size_t converted = scan_ascii_bits(text + i, window, words);
+    for (size_t w = 0; w < converted / 32; w++) {
+      reader.push(words[w], 32);
+      while (reader.available() >= 26) *blocks++ = reader.take(26);
+    }
+    i += converted;
+    if (converted == window) continue;
+
+    // the rest of the window, or the characters around an invalid one
+    for (size_t end = std::min(i + 32, length); i < end; i++) {
+      char c = text[i];
+      if (c != '0' && c != '1') return i;
+      reader.push(c == '1', 1);
+      if (reader.available() == 26) *blocks++ = reader.take(26);
+    }
+  }
+  return length;
+}
+
+BlockWriter::BlockWriter(BitFormat format, int fd, unsigned sample_rate)
+    : format(format), fd(fd), buffer(), used(0), pending(0), pending_count(0), ok(true), closed(false), modulator(), fm(), data_bytes(0) {
+  if (!is_signal_format(format)) return;
+  if (is_iq_format(format)) {
+    modulator.reset(new Modulator(sample_rate, fm_rds_level));
+    fm.reset(new FmModulator(sample_rate));
+    return;
+  }
+  modulator.reset(new Modulator(sample_rate));
+  if (format == FORMAT_F32) return;
+  // the length is filled in by close() where the output can seek
+  char header[wav_header_size];
+  wav_header(header, sample_rate, 0xFFFFFFFF);
+  write_bytes(header, sizeof(header));
+}
+
+void BlockWriter::write_samples(size_t count) {
+  if (fm) {
+    float iq[512];
+    char packed[sizeof(iq)];
+    const size_t pairs = sizeof(iq) / sizeof(iq[0]) / 2;
+    for (size_t i = 0; i < count; i += pairs) {
+      size_t n = std::min(count - i, pairs);
+      fm->modulate(modulator->samples() + i, n, iq);
+      if (format == FORMAT_CF32) {
+        write_bytes(reinterpret_cast<const char *>(iq), 2 * n * sizeof(float));
+        continue;
+      }
+      for (size_t j = 0; j < 2 * n; j++) {
+        if (format == FORMAT_CU8) {
+          packed[j] = static_cast<char>(static_cast<uint8_t>(std::lround(iq[j] * 127.5f + 127.5f)));
+        } else {
+          int16_t value = static_cast<int16_t>(std::lround(iq[j] * 32767.0f));
+          std::memcpy(packed + 2 * j, &value, sizeof(value));
+        }
+      }
+      write_bytes(packed, 2 * n * (format == FORMAT_CU8 ? 1 : sizeof(int16_t)));
+    }
+    return;
+  }
+  if (format == FORMAT_F32) {
+    float samples[256];
+    for (size_t i = 0; i < count; i += sizeof(samples) / sizeof(samples[0])) {
+      size_t n = std::min(count - i, sizeof(samples) / sizeof(samples[0]));
+      for (size_t j = 0; j < n; j++) samples[j] = modulator->samples()[i + j] / 32768.0f;
+      write_bytes(reinterpret_cast<const char *>(samples), n * sizeof(float));
+    }
+    return;
+  }
+  write_bytes(reinterpret_cast<const char *>(modulator->samples()), count * sizeof(int16_t));
+  data_bytes += count * sizeof(int16_t);
+}
+
+void BlockWriter::write_block(uint32_t block) {
+  if (modulator) {
+    write_samples(modulator->modulate(block, 26));
+    return;
+  }
+  if (used + 26 > sizeof(buffer)) drain();
+  if (format == FORMAT_ASCII) {
+    block_to_ascii(block, buffer + used);
+    used += 26;
+    return;
+  }
+  pending = (pending << 26) | (block & block_mask);
+  pending_count += 26;
+  while (pending_count >= 8) {
+    pending_count -= 8;
+    buffer[used++] = static_cast<char>((pending >> pending_count) & 0xFF);
+  }
+}
+
+void BlockWriter::write_bits(uint32_t bits, unsigned count) {
+  if (count == 26) {
+    write_block(bits);
+    return;
+  }
+  if (modulator) {
+    write_samples(modulator->modulate(bits, count));
+    return;
+  }
+  if (used + 26 > sizeof(buffer)) drain();
+  if (format == FORMAT_ASCII) {
+    // the characters after the bits are overwritten by the next write
+    block_to_ascii(bits << (26 - count), buffer + used);
+    used += count;
+    return;
+  }
+  pending = (pending << count) | (bits & ((1u << count) - 1));
+  pending_count += count;
+  while (pending_count >= 8) {
+    pending_count -= 8;
+    buffer[used++] = static_cast<char>((pending >> pending_count) & 0xFF);
+  }
+}
+
+void BlockWriter::write_bytes(const char *data, size_t length) {
+  while (length > 0) {
+    if (used == sizeof(buffer)) drain();
+    size_t n = std::min(length, sizeof(buffer) - used);
+    std::copy(data, data + n, buffer + used);
+    used += n;
+    data += n;
+    length -= n;
+  }
+}
+
+void BlockWriter::flush() {
+  if (format == FORMAT_PACKED && pending_count > 0) {
+    if (used == sizeof(buffer)) drain();
+    buffer[used++] = static_cast<char>((pending << (8 - pending_count)) & 0xFF);
+    pending_count = 0;
+  }
+  drain();
+}
+
+void BlockWriter::close() {
+  if (closed) return;
+  if (modulator) write_samples(modulator->finish());
+  flush();
+  closed = true;
+  if (format != FORMAT_WAV || !ok || lseek(fd, 0, SEEK_CUR) < 0 || data_bytes > 0xFFFFFFFF - 36) return;
+  char header[wav_header_size];
+  wav_header(header, modulator->get_sample_rate(), static_cast<uint32_t>(data_bytes));
+  if (pwrite(fd, header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) ok = false;
+}
+
+void BlockWriter::drain() {
+  size_t written = 0;
+  while (ok && written < used) {
+    ssize_t n = write(fd, buffer + written, used - written);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      ok = false;
+      break;
+    }
+    written += static_cast<size_t>(n);
+  }
+  used = 0;
+}
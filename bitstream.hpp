@@ -0,0 +1,211 @@
+/**
+ * @file       bitstream.hpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Conversion of RDS blocks to and from the ASCII and packed
+ *            binary bitstream formats
+ *
+ * @date      17 October  2026 \n
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+#include "common.hpp"
+#include "rds_modulator.hpp"
+
+/* Formats in which the encoder and decoder exchange bits */
+enum BitFormat {
+  FORMAT_ASCII,  /**< One '0' or '1' character per bit */
+  FORMAT_PACKED, /**< Bits packed MSB-first into bytes, a group is 13 bytes */
+  FORMAT_WAV,    /**< Modulated 57 kHz subcarrier as 16-bit PCM WAV */
+  FORMAT_F32,    /**< Modulated subcarrier as raw 32-bit float samples, no header */
+  FORMAT_CU8,    /**< FM signal as complex baseband, interleaved unsigned 8-bit I/Q */
+  FORMAT_CS16,   /**< FM signal as complex baseband, interleaved 16-bit I/Q */
+  FORMAT_CF32    /**< FM signal as complex baseband, interleaved 32-bit float I/Q */
+};
+
+/**
+ * Parses the name of a bitstream format.
+ * @param name "ascii", "packed", "wav", "f32", "cu8", "cs16" or "cf32".
+ * @param format Where the parsed format is stored.
+ * @return 0 on success, -1 if the name is unknown.
+ */
+int parse_format(const std::string &name, BitFormat &format);
+
+/** Returns true for the formats that carry a signal instead of bits. */
+bool is_signal_format(BitFormat format);
+
+/** Returns true for the complex baseband (IQ) formats of SDR receivers. */
+bool is_iq_format(BitFormat format);
+
+/**
+ * Returns the bytes of one sample (one I/Q pair in IQ formats) of a signal format.
+ * @param format A signal format.
+ */
+size_t sample_size(BitFormat format);
+
+/**
+ * Converts ASCII '0'/'1' characters into bits, 32 characters at a time.
+ * Conversion stops before the first group of 32 characters that contains
+ * anything else, or that would run past the end of the input, so the caller
+ * handles the remaining characters (and reports invalid ones) one by one.
+ * Uses AVX2 or SSE2 when the CPU supports it, selected at runtime.
+ * @param text The characters.
+ * @param length Number of characters.
+ * @param words Output, one word per 32 characters, first character in the
+ *        most significant bit. Needs room for length / 32 words.
+ * @return Number of characters converted, a multiple of 32.
+ */
+size_t scan_ascii_bits(const char *text, size_t length, uint32_t *words);
+
+/**
+ * Portable version of scan_ascii_bits(), the fallback on other CPUs.
+ * @param text The characters.
+ * @param length Number of characters.
+ * @param words Output, one word per 32 characters.
+ * @return Number of characters converted, a multiple of 32.
+ */
+size_t scan_ascii_bits_scalar(const char *text, size_t length, uint32_t *words);
+
+/**
+ * Converts an aligned ASCII bitstream into 26-bit blocks.
+ * @param text The characters, only '0' and '1' are valid.
+ * @param length Number of characters, a multiple of 26.
+ * @param blocks Output, needs room for length / 26 blocks.
+ * @return Index of the first invalid character, length if there is none.
+ */
+size_t parse_ascii_blocks(const char *text, size_t length, uint32_t *blocks);
+
+const size_t writer_buffer_size = 1 << 16; /**< Bytes buffered by BlockWriter */
+
+/**
+ * Writes 26-bit blocks to a file descriptor in the selected format. Blocks
+ * are expanded into a reusable buffer, ASCII with a lookup table, and the
+ * buffer goes out with a single write(2) when it fills up or on flush().
+ * In the signal formats the blocks are modulated by a Modulator; the WAV
+ * header is written first with an unknown length, which close() fills in
+ * if the output is a regular file. The IQ formats carry the subcarrier
+ * frequency modulated by an FmModulator, at the injection level of a
+ * broadcast.
+ */
+class BlockWriter {
+public:
+  /**
+   * Constructor for BlockWriter.
+   * @param format Output format.
+   * @param fd File descriptor to write to.
+   * @param sample_rate Samples per second in the signal formats.
+   */
+  explicit BlockWriter(BitFormat format = FORMAT_ASCII, int fd = STDOUT_FILENO, unsigned sample_rate = default_sample_rate);
+
+  /** Closes the output unless already closed. */
+  ~BlockWriter() { close(); }
+
+  BlockWriter(const BlockWriter &) = delete;
+  BlockWriter &operator=(const BlockWriter &) = delete;
+
+  /**
+   * Writes one block, most significant bit first.
+   * @param block The block, only the low 26 bits are used.
+   */
+  void write_block(uint32_t block);
+
+  /**
+   * Writes bits not aligned to blocks, e.g. after a simulated bit slip.
+   * @param bits The bits, right aligned, most significant bit first.
+   * @param count Number of bits, at most 26.
+   */
+  void write_bits(uint32_t bits, unsigned count);
+
+  /**
+   * Writes raw bytes, e.g. record separators, between blocks.
+   * @param data The bytes.
+   * @param length Number of bytes.
+   */
+  void write_bytes(const char *data, size_t length);
+
+  /**
+   * Writes out everything buffered. In packed format a partial last byte
+   * is padded with zero bits, which never happens for whole groups.
+   */
+  void flush();
+
+  /**
+   * Ends the output: flushes and in WAV format lets the last symbol decay
+   * and fills in the length in the header. Nothing is written afterwards.
+   */
+  void close();
+
+  /** Returns false once a write has failed. */
+  bool good() const { return ok; }
+
+private:
+  /** Writes the buffer out, retrying on partial writes. */
+  void drain();
+
+  /**
+   * Writes samples finished by the modulator.
+   * @param count Number of samples.
+   */
+  void write_samples(size_t count);
+
+  BitFormat format;                  /**< Output format */
+  int fd;                            /**< File descriptor to write to */
+  char buffer[writer_buffer_size];   /**< Output not yet written */
+  size_t used;                       /**< Bytes used in buffer */
+  uint64_t pending;                  /**< Bits not yet written in packed format */
+  unsigned pending_count;            /**< Number of valid low bits in pending */
+  bool ok;                           /**< No write has failed */
+  bool closed;                       /**< close() has been called */
+  std::unique_ptr<Modulator> modulator; /**< Waveform synthesis, signal formats only */
+  std::unique_ptr<FmModulator> fm;      /**< Frequency modulation, IQ formats only */
+  uint64_t data_bytes;               /**< Bytes of samples written, WAV format only */
+};
+
+/**
+ * Collects bits from bytes or characters and hands them out in arbitrary
+ * widths, MSB first. Whole blocks are taken with a single shift and mask.
+ */
+class BitReader {
+public:
+  BitReader() : bits(0), count(0) {}
+
+  /**
+   * Appends bits at the end of the buffer.
+   * @param value The bits, right aligned.
+   * @param width Number of bits to append, at most 32 and at most 64 minus
+   *        available().
+   */
+  void push(uint32_t value, unsigned width) {
+    bits = (bits << width) | (value & ((static_cast<uint64_t>(1) << width) - 1));
+    count += width;
+  }
+
+  /** Returns the number of buffered bits. */
+  unsigned available() const { return count; }
+
+  /**
+   * Removes bits from the front of the buffer.
+   * @param width Number of bits to take, at most available().
+   * @return The bits, right aligned.
+   */
+  uint32_t take(unsigned width) {
+    count -= width;
+    return static_cast<uint32_t>((bits >> count) & ((static_cast<uint64_t>(1) << width) - 1));
+  }
+
+private:
+  uint64_t bits;  /**< Buffered bits, right aligned */
+  unsigned count; /**< Number of buffered bits */
+};
@@ -13,7 +13,11 @@
 
 #include "common.hpp"
 
-uint32_t crc(uint32_t value, uint32_t offset) {
+#include <cstring>
+
+uint32_t crc(uint32_t value, uint32_t offset) { return crc_constexpr(value, offset); }
+
+uint32_t crc_reference(uint32_t value, uint32_t offset) {
   std::bitset<26> and_mask = 0b1111111111;
   std::bitset<26> offset_bitset = offset;
   std::bitset<26> and_check = 1 << 25;
@@ -32,8 +36,65 @@ uint32_t crc(uint32_t value, uint32_t offset) {
   return static_cast<uint32_t>(val.to_ulong());
 }
 
-void print_26_bits(uint32_t value) {
-  for (int i = 25; i >= 0; --i) {
-    std::cout << ((value >> i) & 1);
+/* Message type of every Group Type + Version Code */
+static const GroupType group_types[group_type_codes] = {
+    GROUP_0A, UNKNOWN, UNKNOWN, UNKNOWN, GROUP_2A, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN,
+    UNKNOWN,  UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN,  UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN,
+    UNKNOWN,  UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN,  UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN};
+
+GroupType get_group(uint32_t block) { return group_types[get_group_code(block)]; }
+
+void group_name(uint8_t code, char *name) {
+  unsigned type = (code >> 1) & 0xF;
+  if (type >= 10) *name++ = '1';
+  *name++ = static_cast<char>('0' + type % 10);
+  *name++ = (code & 1) ? 'B' : 'A';
+  *name = '\0';
+}
+
+int get_block_addr(uint32_t block) { return offset_position[get_block_offset(block)]; }
+
+bool is_group_empty(const uint32_t *group) { return !group[0] && !group[1] && !group[2] && !group[3]; }
+
+BlockOffset expected_offset(int position, uint32_t block_b) {
+  static const BlockOffset offsets[4] = {OFFSET_A, OFFSET_B, OFFSET_C, OFFSET_D};
+  if (position < 0 || position > 3) return OFFSET_INVALID;
+  if (position == 2 && (get_group_code(block_b) & 1)) return OFFSET_CP;
+  return offsets[position];
+}
+
+bool correct_block(uint32_t &block, BlockOffset offset) {
+  if (offset == OFFSET_INVALID) return false;
+  uint32_t error = burst_table.pattern[syndrome(block) ^ offset_words[offset]];
+  block ^= error;
+  return error != 0;
+}
+
+/**
+ * The eight characters of every byte value, most significant bit first.
+ */
+struct AsciiTable {
+  char chars[256][8]; /**< Characters for each byte */
+
+  constexpr AsciiTable() : chars() {
+    for (int byte = 0; byte < 256; byte++) {
+      for (int bit = 0; bit < 8; bit++) chars[byte][bit] = ((byte >> (7 - bit)) & 1) ? '1' : '0';
+    }
   }
+};
+
+static constexpr AsciiTable ascii_table{};
+
+void block_to_ascii(uint32_t value, char *out) {
+  out[0] = ((value >> 25) & 1) ? '1' : '0';
+  out[1] = ((value >> 24) & 1) ? '1' : '0';
+  std::memcpy(out + 2, ascii_table.chars[(value >> 16) & 0xFF], 8);
+  std::memcpy(out + 10, ascii_table.chars[(value >> 8) & 0xFF], 8);
+  std::memcpy(out + 18, ascii_table.chars[value & 0xFF], 8);
+}
+
+void print_26_bits(uint32_t value) {
+  char text[26];
+  block_to_ascii(value, text);
+  std::cout.write(text, sizeof(text));
 }
@@ -13,8 +13,9 @@
  */
 
 #pragma once
-#include <cstdint>
 #include <bitset>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 
 /* Constants for offsets and masks used in CRC and data extraction */
@@ -22,9 +23,17 @@ const uint32_t offset_A = 252;
 const uint32_t offset_B = 408;
 const uint32_t offset_C = 360;
 const uint32_t offset_D = 436;
+const uint32_t offset_Cp = 848; /**< Offset C' used by version B groups */
 
 const uint8_t group_type_code_0A = 0b00000; /* Code for Group 0A */
+const uint8_t group_type_code_0B = 0b00001; /* Code for Group 0B */
 const uint8_t group_type_code_2A = 0b00100; /* Code for Group 2A */
+const uint8_t group_type_code_2B = 0b00101; /* Code for Group 2B */
+const uint8_t group_type_code_4A = 0b01000; /* Code for Group 4A */
+const unsigned group_type_codes = 32;       /* Number of Group Type + Version Code values */
+
+const double bit_rate = 1187.5;  /**< RDS bits per second, 57 kHz / 48 */
+const double subcarrier = 57000; /**< RDS subcarrier frequency in Hz */
 
 /* Enum for RDS group types */
 enum GroupType {
@@ -33,8 +42,346 @@ enum GroupType {
   UNKNOWN   /**< Unknown group type */
 };
 
+/**
+ * Describes where a field lies inside a group: the index of its block, the
+ * bit position of its least significant bit within the 26-bit block and its
+ * width. The encoder packs and the decoder extracts every field through
+ * these descriptors, which compile down to one shift and one mask.
+ */
+template <unsigned Block, unsigned Offset, unsigned Width> struct Field {
+  static_assert(Block < 4, "A group has four blocks");
+  static_assert(Width > 0 && Offset >= 10 && Offset + Width <= 26, "A field must lie inside the 16-bit information word");
+
+  static constexpr unsigned block = Block;                                 /**< Index of the block in the group */
+  static constexpr unsigned offset = Offset;                               /**< Position of the least significant bit */
+  static constexpr unsigned width = Width;                                 /**< Width in bits */
+  static constexpr uint32_t mask = ((uint32_t{1} << Width) - 1) << Offset; /**< Mask of the field in its block */
+
+  /**
+   * Places a value into the field. Bits beyond the width are dropped.
+   * @param value The value.
+   * @return The block bits of the field.
+   */
+  static constexpr uint32_t pack(uint32_t value) { return (value << Offset) & mask; }
+
+  /**
+   * Reads the field from its block.
+   * @param block The block value.
+   * @return The value of the field.
+   */
+  static constexpr uint32_t extract(uint32_t block) { return (block & mask) >> Offset; }
+
+  /**
+   * Reads the field from a group.
+   * @param group The group in A, B, C, D order.
+   * @return The value of the field.
+   */
+  static constexpr uint32_t extract(const uint32_t *group) { return extract(group[Block]); }
+};
+
+/**
+ * Checks that no two fields of a layout share a bit of the same block.
+ * @return true if the fields are disjoint.
+ */
+template <typename... Fields> constexpr bool fields_disjoint() {
+  const unsigned blocks[] = {Fields::block...};
+  const uint32_t masks[] = {Fields::mask...};
+  for (size_t i = 0; i < sizeof...(Fields); i++) {
+    for (size_t j = i + 1; j < sizeof...(Fields); j++) {
+      if (blocks[i] == blocks[j] && (masks[i] & masks[j]) != 0) return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Combines the masks of the fields of a layout that lie in one block.
+ * @param block Index of the block.
+ * @return The bits of the block covered by the fields.
+ */
+template <typename... Fields> constexpr uint32_t fields_mask(unsigned block) {
+  const unsigned blocks[] = {Fields::block...};
+  const uint32_t masks[] = {Fields::mask...};
+  uint32_t mask = 0;
+  for (size_t i = 0; i < sizeof...(Fields); i++) {
+    if (blocks[i] == block) mask |= masks[i];
+  }
+  return mask;
+}
+
+/* Fields shared by every group type */
+struct GroupLayout {
+  using Pi = Field<0, 10, 16>;       /**< Program Identification */
+  using GroupCode = Field<1, 21, 5>; /**< Group Type Code + Version Code */
+  using Tp = Field<1, 20, 1>;        /**< Traffic Program flag */
+  using Pty = Field<1, 15, 5>;       /**< Program Type */
+};
+
+/* Group 0A, basic tuning and switching information */
+struct Layout0A : GroupLayout {
+  using Ta = Field<1, 14, 1>;      /**< Traffic Announcement flag */
+  using Ms = Field<1, 13, 1>;      /**< Music/Speech flag */
+  using Di = Field<1, 12, 1>;      /**< Decoder Identification bit of the segment */
+  using Segment = Field<1, 10, 2>; /**< Segment address */
+  using Af1 = Field<2, 18, 8>;     /**< Alternative Frequency #1 */
+  using Af2 = Field<2, 10, 8>;     /**< Alternative Frequency #2 */
+  using Ps1 = Field<3, 18, 8>;     /**< First PS character of the segment */
+  using Ps2 = Field<3, 10, 8>;     /**< Second PS character of the segment */
+};
+
+/* Group 0B, as 0A with the PI code in block C' instead of AF */
+struct Layout0B : Layout0A {
+  using PiC = Field<2, 10, 16>; /**< Program Identification repeated in C' */
+};
+
+/* Group 2A, Radio Text with four characters per group */
+struct Layout2A : GroupLayout {
+  using Ab = Field<1, 14, 1>;      /**< Radio Text A/B flag */
+  using Segment = Field<1, 10, 4>; /**< Segment address */
+  using Rt1 = Field<2, 18, 8>;     /**< RT characters of the segment, in order */
+  using Rt2 = Field<2, 10, 8>;
+  using Rt3 = Field<3, 18, 8>;
+  using Rt4 = Field<3, 10, 8>;
+};
+
+/* Group 2B, Radio Text with two characters per group and the PI code in C' */
+struct Layout2B : GroupLayout {
+  using Ab = Field<1, 14, 1>;      /**< Radio Text A/B flag */
+  using Segment = Field<1, 10, 4>; /**< Segment address */
+  using PiC = Field<2, 10, 16>;    /**< Program Identification repeated in C' */
+  using Rt1 = Field<3, 18, 8>;     /**< RT characters of the segment, in order */
+  using Rt2 = Field<3, 10, 8>;
+};
+
+/* Group 4A, clock time and date */
+struct Layout4A : GroupLayout {
+  using Spare = Field<1, 12, 3>;    /**< Unused bits of block B */
+  using MjdHigh = Field<1, 10, 2>;  /**< Modified Julian Day, bits 16-15 */
+  using MjdLow = Field<2, 11, 15>;  /**< Modified Julian Day, bits 14-0 */
+  using HourHigh = Field<2, 10, 1>; /**< UTC hour, bit 4 */
+  using HourLow = Field<3, 22, 4>;  /**< UTC hour, bits 3-0 */
+  using Minute = Field<3, 16, 6>;   /**< UTC minute */
+  using OffsetSign = Field<3, 15, 1>; /**< Local time offset sign, 1 for negative */
+  using Offset = Field<3, 10, 5>;   /**< Local time offset in half hours */
+};
+
+static_assert(fields_disjoint<Layout0A::Pi, Layout0A::GroupCode, Layout0A::Tp, Layout0A::Pty, Layout0A::Ta, Layout0A::Ms, Layout0A::Di,
+                              Layout0A::Segment, Layout0A::Af1, Layout0A::Af2, Layout0A::Ps1, Layout0A::Ps2>(),
+              "Fields of group 0A overlap");
+static_assert(fields_mask<Layout0A::GroupCode, Layout0A::Tp, Layout0A::Pty, Layout0A::Ta, Layout0A::Ms, Layout0A::Di, Layout0A::Segment>(1) ==
+                  0x3FFFC00,
+              "Fields of group 0A must fill block B");
+static_assert(fields_disjoint<Layout0B::GroupCode, Layout0B::Tp, Layout0B::Pty, Layout0B::Ta, Layout0B::Ms, Layout0B::Di, Layout0B::Segment,
+                              Layout0B::PiC, Layout0B::Ps1, Layout0B::Ps2>(),
+              "Fields of group 0B overlap");
+static_assert(fields_disjoint<Layout2A::Pi, Layout2A::GroupCode, Layout2A::Tp, Layout2A::Pty, Layout2A::Ab, Layout2A::Segment, Layout2A::Rt1,
+                              Layout2A::Rt2, Layout2A::Rt3, Layout2A::Rt4>(),
+              "Fields of group 2A overlap");
+static_assert(fields_mask<Layout2A::GroupCode, Layout2A::Tp, Layout2A::Pty, Layout2A::Ab, Layout2A::Segment>(1) == 0x3FFFC00 &&
+                  fields_mask<Layout2A::Rt1, Layout2A::Rt2>(2) == 0x3FFFC00 && fields_mask<Layout2A::Rt3, Layout2A::Rt4>(3) == 0x3FFFC00,
+              "Fields of group 2A must fill blocks B, C and D");
+static_assert(fields_disjoint<Layout2B::GroupCode, Layout2B::Tp, Layout2B::Pty, Layout2B::Ab, Layout2B::Segment, Layout2B::PiC, Layout2B::Rt1,
+                              Layout2B::Rt2>(),
+              "Fields of group 2B overlap");
+static_assert(fields_disjoint<Layout4A::GroupCode, Layout4A::Tp, Layout4A::Pty, Layout4A::Spare, Layout4A::MjdHigh, Layout4A::MjdLow,
+                              Layout4A::HourHigh, Layout4A::HourLow, Layout4A::Minute, Layout4A::OffsetSign, Layout4A::Offset>(),
+              "Fields of group 4A overlap");
+static_assert(fields_mask<Layout4A::MjdLow, Layout4A::HourHigh>(2) == 0x3FFFC00 &&
+                  fields_mask<Layout4A::HourLow, Layout4A::Minute, Layout4A::OffsetSign, Layout4A::Offset>(3) == 0x3FFFC00,
+              "Fields of group 4A must fill blocks C and D");
+
+const uint32_t crc_mask = 0x3FF;                      /**< Mask for CRC */
+const uint32_t inv_crc_mask = 0x3FFFC00;              /**< Inverse CRC mask */
+
+
 constexpr std::bitset<26> crc_bitset = 0b10110111001; /**< CRC polynomial */
 
+const uint32_t block_mask = 0x3FFFFFF; /**< Mask for a whole 26-bit block */
+
+/**
+ * Reads the CRC polynomial out of crc_bitset at compile time.
+ * @return The polynomial as a 32-bit integer.
+ */
+constexpr uint32_t crc_polynomial() {
+  uint32_t poly = 0;
+  for (size_t i = 0; i < crc_bitset.size(); i++) {
+    if (crc_bitset[i]) poly |= static_cast<uint32_t>(1) << i;
+  }
+  return poly;
+}
+
+/**
+ * Compute the 10-bit checkword of a 16-bit information word by polynomial
+ * long division, one bit at a time. Only used to build the lookup tables.
+ * @param info The 16-bit information word.
+ * @return The checkword without an offset word applied.
+ */
+constexpr uint16_t crc_checkword(uint16_t info) {
+  uint32_t reg = static_cast<uint32_t>(info) << 10;
+  for (int i = 15; i >= 0; i--) {
+    if (reg & (static_cast<uint32_t>(1) << (i + 10))) reg ^= crc_polynomial() << i;
+  }
+  return static_cast<uint16_t>(reg & 0x3FF);
+}
+
+/**
+ * Byte-wise checkword tables. The checkword is linear in the information
+ * word, so it is the XOR of the checkwords of its high and low byte.
+ */
+struct CrcTable {
+  uint16_t hi[256]; /**< Checkwords of info words 0xXX00 */
+  uint16_t lo[256]; /**< Checkwords of info words 0x00XX */
+
+  constexpr CrcTable() : hi(), lo() {
+    for (uint32_t i = 0; i < 256; i++) {
+      hi[i] = crc_checkword(static_cast<uint16_t>(i << 8));
+      lo[i] = crc_checkword(static_cast<uint16_t>(i));
+    }
+  }
+};
+
+constexpr CrcTable crc_table{}; /**< Tables generated at compile time */
+
+/**
+ * Table-driven CRC usable in constant expressions, e.g. for blocks whose
+ * content is known at compile time.
+ * @param value The input value (information word in bits 25..10).
+ * @param offset The offset to apply in the computation.
+ * @return The computed CRC, identical to crc().
+ */
+constexpr uint32_t crc_constexpr(uint32_t value, uint32_t offset) {
+  return (crc_table.hi[(value >> 18) & 0xFF] ^ crc_table.lo[(value >> 10) & 0xFF] ^ (value & 0x3FF) ^ offset) & block_mask;
+}
+
+static_assert(crc_polynomial() == 0x5B9, "CRC polynomial must be x^10+x^8+x^7+x^5+x^4+x^3+1");
+static_assert(crc_constexpr(0, offset_A) == offset_A, "Checkword of an empty block is the offset word");
+
+/* Offset words a block can carry, in the order of BlockOffset */
+enum BlockOffset : uint8_t {
+  OFFSET_A,      /**< Block 1 */
+  OFFSET_B,      /**< Block 2 */
+  OFFSET_C,      /**< Block 3 of version A groups */
+  OFFSET_CP,     /**< Block 3 of version B groups */
+  OFFSET_D,      /**< Block 4 */
+  OFFSET_INVALID /**< Syndrome matches no offset word */
+};
+
+constexpr uint32_t offset_words[] = {offset_A, offset_B, offset_C, offset_Cp, offset_D};
+
+/* Position of a block inside its group for each BlockOffset, -1 if invalid */
+constexpr int offset_position[] = {0, 1, 2, 2, 3, -1};
+
+/**
+ * Computes the syndrome of a whole 26-bit block. For an error-free block it
+ * equals the offset word the block was sent with.
+ * @param block The received block.
+ * @return The 10-bit syndrome.
+ */
+constexpr uint32_t syndrome(uint32_t block) { return crc_constexpr(block, 0); }
+
+/**
+ * Maps each of the 1024 possible syndromes to the offset word it identifies.
+ */
+struct SyndromeTable {
+  uint8_t offset[1024]; /**< BlockOffset for each syndrome */
+
+  constexpr SyndromeTable() : offset() {
+    for (uint32_t s = 0; s < 1024; s++) offset[s] = OFFSET_INVALID;
+    for (uint8_t o = OFFSET_A; o < OFFSET_INVALID; o++) offset[offset_words[o]] = o;
+  }
+};
+
+constexpr SyndromeTable syndrome_table{}; /**< Table generated at compile time */
+
+/**
+ * Identifies the offset word of a block with a single syndrome computation.
+ * @param block The received block.
+ * @return The matching offset, OFFSET_INVALID if the block is corrupted.
+ */
+constexpr BlockOffset get_block_offset(uint32_t block) { return static_cast<BlockOffset>(syndrome_table.offset[syndrome(block)]); }
+
+const uint32_t max_burst_length = 5; /**< Longest error burst the code corrects */
+
+/**
+ * Maps the syndrome of every error burst of up to max_burst_length bits to
+ * the burst itself. The (26,16) code gives each such burst a unique syndrome.
+ */
+struct BurstTable {
+  uint32_t pattern[1024]; /**< Error pattern for each syndrome, 0 if not a burst */
+
+  constexpr BurstTable() : pattern() {
+    for (uint32_t length = 1; length <= max_burst_length; length++) {
+      // bursts start and end with an error bit, anything may lie in between
+      uint32_t inner_count = length > 2 ? 1 << (length - 2) : 1;
+      for (uint32_t inner = 0; inner < inner_count; inner++) {
+        uint32_t burst = length == 1 ? 1 : (1 | (inner << 1) | (1 << (length - 1)));
+        for (uint32_t shift = 0; shift + length <= 26; shift++) {
+          pattern[syndrome(burst << shift)] = burst << shift;
+        }
+      }
+    }
+  }
+};
+
+constexpr BurstTable burst_table{}; /**< Table generated at compile time */
+
+/**
+ * Repairs a burst error in a block whose offset word is known.
+ * The syndrome of the error is the block syndrome with the expected offset
+ * word removed, so one lookup finds the error pattern.
+ * @param block The received block, corrected in place on success.
+ * @param offset Offset word the block was sent with, see expected_offset().
+ * @return true if the block was corrected, false if it is uncorrectable.
+ */
+bool correct_block(uint32_t &block, BlockOffset offset);
+
+/**
+ * Extracts the Group Type Code + Version Code from block B.
+ * @param block The 26-bit block value
+ * @return The 5-bit code, e.g. 0b00101 for 2B
+ */
+inline uint8_t get_group_code(uint32_t block) { return static_cast<uint8_t>(GroupLayout::GroupCode::extract(block)); }
+
+/**
+ * Determines the RDS group type from block B.
+ * Used by the message paths, which decode 0A and 2A only; the other types are
+ * handled by the per-type table in rds_stations.cpp, reached with --stations.
+ * @param block The 26-bit block value
+ * @return GROUP_0A or GROUP_2A, UNKNOWN for every other type
+ */
+GroupType get_group(uint32_t block);
+
+/**
+ * Determines the offset word of a block from its position in the group.
+ * The third block carries C' in version B groups, so it depends on block B.
+ * @param position Position of the block in its group (0-3).
+ * @param block_b Block B of the group, only read for position 2.
+ * @return The offset word, OFFSET_INVALID for a position out of range.
+ */
+BlockOffset expected_offset(int position, uint32_t block_b);
+
+/**
+ * Names a Group Type Code + Version Code.
+ * @param code The 5-bit code.
+ * @param name Output, at least 4 characters, e.g. "15B", terminated.
+ */
+void group_name(uint8_t code, char *name);
+
+/**
+ * Determines the position of a block inside its group from its syndrome.
+ * @param block The 26-bit block value
+ * @return 0-3 for offsets A, B, C/C', D; -1 if no offset word matches
+ */
+int get_block_addr(uint32_t block);
+
+/**
+ * Checks whether all four blocks of a group are zero, which marks a group
+ * that was not received.
+ * @param group The four blocks of the group.
+ * @return true if the group is empty.
+ */
+bool is_group_empty(const uint32_t *group);
+
 /**
  * Compute CRC for a given value and offset.
  * @param value The input value.
@@ -43,6 +390,23 @@ constexpr std::bitset<26> crc_bitset = 0b10110111001; /**< CRC polynomial */
  */
 uint32_t crc(uint32_t value, uint32_t offset);
 
+/**
+ * Reference bit-by-bit CRC implementation, kept to verify and benchmark
+ * the table-driven crc().
+ * @param value The input value.
+ * @param offset The offset to apply in the computation.
+ * @return The computed CRC as a 32-bit integer.
+ */
+uint32_t crc_reference(uint32_t value, uint32_t offset);
+
+/**
+ * Expands a block into 26 ASCII '0'/'1' characters, most significant bit
+ * first, using a byte-to-characters lookup table.
+ * @param value The block, only the low 26 bits are used.
+ * @param out Destination for exactly 26 characters, not terminated.
+ */
+void block_to_ascii(uint32_t value, char *out);
+
 /**
  * Print 26 bits of a value.
  * @param value The 32-bit value to process.
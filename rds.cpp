@@ -0,0 +1,336 @@
+/**
+ * @file       rds.cpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     librds, encoding and decoding of RDS groups 0A and 2A on
+ *            caller-provided buffers
+ *
+ * @date      17 October  2026 \n
+ */
+
+#include "rds.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "bitstream.hpp"
+#include "common.hpp"
+
+/* Block C of 0A groups carries no AF pair after the first segment */
+constexpr uint32_t empty_block_C = crc_constexpr(0, offset_C);
+
+static_assert(RDS_GROUP_0A == GROUP_0A && RDS_GROUP_2A == GROUP_2A && RDS_GROUP_UNKNOWN == UNKNOWN, "Group type values must match GroupType");
+
+/**
+ * Builds block A, which only carries the PI code.
+ * @param pi Program Identification.
+ * @return The checkworded block.
+ */
+static uint32_t encode_block_A(uint16_t pi) {
+  uint32_t line = GroupLayout::Pi::pack(pi);
+  return line | crc(line, offset_A);
+}
+
+uint32_t rds_encode_0a_block(const rds_0a_config *config, unsigned index) {
+  using L = Layout0A;
+  uint32_t segment = index / 4;
+  uint32_t line{};
+  switch (index % 4) {
+  case 0:
+    return encode_block_A(config->pi);
+  case 1:
+    line = L::GroupCode::pack(group_type_code_0A) | L::Tp::pack(config->tp) | L::Pty::pack(config->pty) | L::Ta::pack(config->ta) |
+           L::Ms::pack(config->ms) | L::Segment::pack(segment);
+    return line | crc(line, offset_B);
+  case 2:
+    // only the first segment carries the AF pair
+    if (segment != 0) return empty_block_C;
+    line = L::Af1::pack(config->af1) | L::Af2::pack(config->af2);
+    return line | crc(line, offset_C);
+  default:
+    line = L::Ps1::pack(static_cast<uint8_t>(config->ps[segment * 2])) | L::Ps2::pack(static_cast<uint8_t>(config->ps[segment * 2 + 1]));
+    return line | crc(line, offset_D);
+  }
+}
+
+size_t rds_encode_0a(const rds_0a_config *config, uint32_t *blocks, size_t capacity) {
+  if (capacity < RDS_0A_BLOCKS) return 0;
+  for (unsigned i = 0; i < RDS_0A_BLOCKS; i++) blocks[i] = rds_encode_0a_block(config, i);
+  return RDS_0A_BLOCKS;
+}
+
+unsigned rds_rt_segments(const rds_2a_config *config) {
+  const void *end = std::memchr(config->rt, RDS_RT_END, RDS_RT_LENGTH);
+  if (!end) return RDS_2A_BLOCKS / RDS_GROUP_BLOCKS;
+  return static_cast<unsigned>(static_cast<const char *>(end) - config->rt) / 4 + 1;
+}
+
+uint32_t rds_encode_2a_block(const rds_2a_config *config, unsigned index) {
+  using L = Layout2A;
+  const uint8_t *rt = reinterpret_cast<const uint8_t *>(config->rt);
+  uint32_t segment = index / 4;
+  uint32_t line{};
+  switch (index % 4) {
+  case 0:
+    return encode_block_A(config->pi);
+  case 1:
+    line = L::GroupCode::pack(group_type_code_2A) | L::Tp::pack(config->tp) | L::Pty::pack(config->pty) | L::Ab::pack(config->ab) |
+           L::Segment::pack(segment);
+    return line | crc(line, offset_B);
+  case 2:
+    // radio text segment
+    line = L::Rt1::pack(rt[segment * 4]) | L::Rt2::pack(rt[segment * 4 + 1]);
+    return line | crc(line, offset_C);
+  default:
+    line = L::Rt3::pack(rt[segment * 4 + 2]) | L::Rt4::pack(rt[segment * 4 + 3]);
+    return line | crc(line, offset_D);
+  }
+}
+
+size_t rds_encode_2a(const rds_2a_config *config, uint32_t *blocks, size_t capacity) {
+  if (capacity < RDS_2A_BLOCKS) return 0;
+  size_t count = rds_rt_segments(config) * RDS_GROUP_BLOCKS;
+  for (unsigned i = 0; i < count; i++) blocks[i] = rds_encode_2a_block(config, i);
+  return count;
+}
+
+size_t rds_encode_4a(const rds_4a_config *config, uint32_t *blocks, size_t capacity) {
+  using L = Layout4A;
+  if (capacity < RDS_4A_BLOCKS) return 0;
+  uint32_t mjd = config->mjd;
+  int offset = config->local_offset;
+  blocks[0] = encode_block_A(config->pi);
+
+  uint32_t line = L::GroupCode::pack(group_type_code_4A) | L::Tp::pack(config->tp) | L::Pty::pack(config->pty) |
+                  L::MjdHigh::pack(mjd >> L::MjdLow::width);
+  blocks[1] = line | crc(line, offset_B);
+
+  line = L::MjdLow::pack(mjd) | L::HourHigh::pack(config->hour >> L::HourLow::width);
+  blocks[2] = line | crc(line, offset_C);
+
+  line = L::HourLow::pack(config->hour) | L::Minute::pack(config->minute) | L::OffsetSign::pack(offset < 0) |
+         L::Offset::pack(static_cast<uint32_t>(offset < 0 ? -offset : offset));
+  blocks[3] = line | crc(line, offset_D);
+  return RDS_4A_BLOCKS;
+}
+
+size_t rds_blocks_to_ascii(const uint32_t *blocks, size_t count, char *text, size_t capacity) {
+  if (capacity / RDS_BLOCK_BITS < count) return 0;
+  for (size_t i = 0; i < count; i++) block_to_ascii(blocks[i], text + i * RDS_BLOCK_BITS);
+  return count * RDS_BLOCK_BITS;
+}
+
+int rds_ascii_to_blocks(const char *text, size_t length, uint32_t *blocks, size_t capacity, size_t *count) {
+  if (length % RDS_BLOCK_BITS) return RDS_ERROR_INVALID_LENGTH;
+  if (capacity < length / RDS_BLOCK_BITS) return RDS_ERROR_BUFFER_TOO_SMALL;
+  size_t invalid = parse_ascii_blocks(text, length, blocks);
+  if (invalid != length) {
+    *count = invalid;
+    return RDS_ERROR_INVALID_CHARACTER;
+  }
+  *count = length / RDS_BLOCK_BITS;
+  return RDS_OK;
+}
+
+int rds_sort_group(const uint32_t *in, int correct, uint32_t *out, uint8_t *bad_blocks) {
+  uint8_t bad = 0;
+  uint8_t filled = 0;
+  bool duplicate = false;
+  std::fill(out, out + RDS_GROUP_BLOCKS, 0);
+  for (int j = 0; j < RDS_GROUP_BLOCKS; j++) {
+    int block_addr = get_block_addr(in[j]);
+    if (block_addr == -1) {
+      bad |= static_cast<uint8_t>(1 << j);
+      continue;
+    }
+    duplicate |= (filled >> block_addr) & 1;
+    filled |= static_cast<uint8_t>(1 << block_addr);
+    out[block_addr] = in[j];
+  }
+  // blocks that match no offset are assumed to be in transmission order, block B
+  // is placed first so the third block is repaired against C or C' as it says
+  for (int j = 0; correct && j < RDS_GROUP_BLOCKS; j++) {
+    uint32_t block = in[j];
+    if (!(bad & (1 << j)) || !correct_block(block, expected_offset(j, out[1]))) continue;
+    duplicate |= (filled >> j) & 1;
+    filled |= static_cast<uint8_t>(1 << j);
+    out[j] = block;
+    bad &= static_cast<uint8_t>(~(1 << j));
+  }
+  if (bad_blocks) *bad_blocks = bad;
+  if (bad) return RDS_ERROR_CRC;
+  // four blocks without a bad one leave a position empty only if two share one
+  return duplicate ? RDS_ERROR_DUPLICATE_BLOCK : RDS_OK;
+}
+
+/**
+ * Checks the fields every group of a message shares against the first
+ * group and stores them from the first group.
+ * @param out Message being decoded.
+ * @param group The group in A, B, C, D order.
+ * @param first Whether this is the first group of the message.
+ * @param check_ta_ms Whether TA and MS are shared too (0A).
+ * @return RDS_OK or one of the RDS_ERROR_INCONSISTENT_* codes.
+ */
+static int decode_common(rds_decoded *out, const uint32_t *group, bool first, bool check_ta_ms) {
+  uint16_t pi = static_cast<uint16_t>(GroupLayout::Pi::extract(group));
+  uint8_t gt_vc = static_cast<uint8_t>(GroupLayout::GroupCode::extract(group));
+  uint8_t tp = static_cast<uint8_t>(GroupLayout::Tp::extract(group));
+  uint8_t pty = static_cast<uint8_t>(GroupLayout::Pty::extract(group));
+  uint8_t ta = static_cast<uint8_t>(Layout0A::Ta::extract(group));
+  uint8_t ms = static_cast<uint8_t>(Layout0A::Ms::extract(group));
+
+  if (first) {
+    out->pi = pi;
+    out->group_type = gt_vc;
+    out->tp = tp;
+    out->pty = pty;
+    out->ta = ta;
+    out->ms = ms;
+    return RDS_OK;
+  }
+  if (pi != out->pi) return RDS_ERROR_INCONSISTENT_PI;
+  if (gt_vc != out->group_type) return RDS_ERROR_INCONSISTENT_GROUP_TYPE;
+  if (tp != out->tp) return RDS_ERROR_INCONSISTENT_TP;
+  if (pty != out->pty) return RDS_ERROR_INCONSISTENT_PTY;
+  if (check_ta_ms && ta != out->ta) return RDS_ERROR_INCONSISTENT_TA;
+  if (check_ta_ms && ms != out->ms) return RDS_ERROR_INCONSISTENT_MS;
+  return RDS_OK;
+}
+
+void rds_assembler_init(rds_assembler *assembler) {
+  assembler->group_type = -1;
+  assembler->present = 0;
+  assembler->first_segment = 0;
+  assembler->segments = 0;
+  assembler->status = RDS_OK;
+  rds_decoded &message = assembler->message;
+  std::fill(message.ps, message.ps + RDS_PS_LENGTH, '_');
+  std::fill(message.rt, message.rt + RDS_RT_LENGTH, '_');
+  message.ps[RDS_PS_LENGTH] = '\0';
+  message.rt[RDS_RT_LENGTH] = '\0';
+}
+
+int rds_assembler_push(rds_assembler *assembler, const uint32_t *group) {
+  if (assembler->group_type == -1) {
+    assembler->group_type = get_group(group[1]);
+    assembler->segments = assembler->group_type == RDS_GROUP_0A ? 4 : 16;
+  }
+  if (assembler->group_type == RDS_GROUP_UNKNOWN) return RDS_ERROR_UNSUPPORTED_GROUP;
+
+  // groups of another type land by the segment bits of the message type
+  // and are caught by the consistency check below
+  bool is_0A = assembler->group_type == RDS_GROUP_0A;
+  rds_decoded &message = assembler->message;
+  uint32_t segment = is_0A ? Layout0A::Segment::extract(group) : Layout2A::Segment::extract(group);
+  if (is_0A) {
+    message.ps[segment * 2] = static_cast<char>(Layout0A::Ps1::extract(group));
+    message.ps[segment * 2 + 1] = static_cast<char>(Layout0A::Ps2::extract(group));
+  } else {
+    message.rt[segment * 4] = static_cast<char>(Layout2A::Rt1::extract(group));
+    message.rt[segment * 4 + 1] = static_cast<char>(Layout2A::Rt2::extract(group));
+    message.rt[segment * 4 + 2] = static_cast<char>(Layout2A::Rt3::extract(group));
+    message.rt[segment * 4 + 3] = static_cast<char>(Layout2A::Rt4::extract(group));
+    // the text ends in this segment, later ones are not sent
+    if (std::memchr(message.rt + segment * 4, RDS_RT_END, 4) && segment < assembler->segments) {
+      assembler->segments = static_cast<uint8_t>(segment + 1);
+    }
+  }
+
+  bool first = assembler->present == 0;
+  if (first || segment <= assembler->first_segment) {
+    // fields sent once per message are taken from the lowest segment
+    assembler->first_segment = static_cast<uint8_t>(segment);
+    message.di = static_cast<uint8_t>(Layout0A::Di::extract(group));
+    message.ab = static_cast<uint8_t>(Layout2A::Ab::extract(group));
+    message.af1 = static_cast<uint8_t>(Layout0A::Af1::extract(group));
+    message.af2 = static_cast<uint8_t>(Layout0A::Af2::extract(group));
+  }
+  if (assembler->status == RDS_OK) assembler->status = decode_common(&message, group, first, is_0A);
+  assembler->present |= static_cast<uint16_t>(1 << segment);
+  return RDS_OK;
+}
+
+int rds_assembler_complete(const rds_assembler *assembler) {
+  uint16_t needed = static_cast<uint16_t>((1u << assembler->segments) - 1);
+  return assembler->group_type != RDS_GROUP_UNKNOWN && __builtin_popcount(assembler->present & needed) == assembler->segments;
+}
+
+int rds_assembler_decode(const rds_assembler *assembler, rds_decoded *out) {
+  if (assembler->present == 0) return RDS_ERROR_EMPTY;
+  if (assembler->group_type != RDS_GROUP_0A && assembler->group_type != RDS_GROUP_2A) return RDS_ERROR_UNSUPPORTED_GROUP;
+  if (assembler->status != RDS_OK) return assembler->status;
+
+  *out = assembler->message;
+  // the type is reported as the message type, not the raw type code
+  out->group_type = static_cast<uint8_t>(assembler->group_type);
+  if (out->group_type == RDS_GROUP_2A) {
+    char *end = static_cast<char *>(std::memchr(out->rt, RDS_RT_END, assembler->segments * 4u));
+    if (end) *end = '\0';
+  }
+  return RDS_OK;
+}
+
+int rds_decode(const uint32_t *blocks, size_t count, int correct, rds_decoded *out) {
+  rds_assembler assembler;
+  rds_assembler_init(&assembler);
+  uint32_t sorted[RDS_GROUP_BLOCKS];
+  bool skipped = false;
+
+  for (size_t i = 0; i + RDS_GROUP_BLOCKS <= count; i += RDS_GROUP_BLOCKS) {
+    // skip empty groups
+    if (is_group_empty(blocks + i)) continue;
+    int status = rds_sort_group(blocks + i, correct, sorted, nullptr);
+    if (status != RDS_OK) {
+      if (!correct) return status;
+      continue;
+    }
+    // groups of other types are skipped
+    if (get_group(sorted[1]) == UNKNOWN) {
+      skipped = true;
+      continue;
+    }
+    rds_assembler_push(&assembler, sorted);
+  }
+  if (assembler.present == 0) return skipped ? RDS_ERROR_UNSUPPORTED_GROUP : RDS_ERROR_EMPTY;
+  return rds_assembler_decode(&assembler, out);
+}
+
+const char *rds_status_message(int status) {
+  switch (status) {
+  case RDS_OK:
+    return "OK";
+  case RDS_ERROR_CRC:
+    return "Block matches no offset word";
+  case RDS_ERROR_EMPTY:
+    return "No complete group found";
+  case RDS_ERROR_UNSUPPORTED_GROUP:
+    return "Unsupported group type";
+  case RDS_ERROR_INCONSISTENT_PI:
+    return "Inconsistent PI value across blocks";
+  case RDS_ERROR_INCONSISTENT_GROUP_TYPE:
+    return "Inconsistent Group Type or Version Code value across blocks";
+  case RDS_ERROR_INCONSISTENT_TP:
+    return "Inconsistent TP value across blocks";
+  case RDS_ERROR_INCONSISTENT_PTY:
+    return "Inconsistent PTY value across blocks";
+  case RDS_ERROR_INCONSISTENT_TA:
+    return "Inconsistent TA value across blocks";
+  case RDS_ERROR_INCONSISTENT_MS:
+    return "Inconsistent MS value across blocks";
+  case RDS_ERROR_INVALID_CHARACTER:
+    return "Invalid character in binary value";
+  case RDS_ERROR_BUFFER_TOO_SMALL:
+    return "Output buffer too small";
+  case RDS_ERROR_DUPLICATE_BLOCK:
+    return "Two blocks of a group carry the same offset word";
+  case RDS_ERROR_INVALID_LENGTH:
+    return "Invalid length of binary value";
+  default:
+    return "Unknown error";
+  }
+}
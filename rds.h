@@ -0,0 +1,270 @@
+/**
+ * @file       rds.h
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     librds public interface, encoding and decoding of RDS groups
+ *            0A and 2A. Every function works on caller-provided buffers and
+ *            never allocates memory or prints anything. The interface is
+ *            plain C so it can be used from other languages.
+ *
+ * @date      17 October  2026 \n
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RDS_BLOCK_BITS 26  /**< Bits per block */
+#define RDS_GROUP_BLOCKS 4 /**< Blocks per group */
+#define RDS_0A_BLOCKS 16   /**< Blocks in a full 0A message (4 groups) */
+#define RDS_2A_BLOCKS 64   /**< Blocks in a full 2A message (16 groups) */
+#define RDS_4A_BLOCKS 4    /**< Blocks in a 4A message (1 group) */
+#define RDS_PS_LENGTH 8    /**< Characters of the Program Service name */
+#define RDS_RT_LENGTH 64   /**< Characters of the Radio Text */
+#define RDS_RT_END '\r'    /**< Ends a Radio Text shorter than RDS_RT_LENGTH */
+
+/* Group types, same values as GroupType */
+#define RDS_GROUP_0A 0 /**< Basic tuning and switching information */
+#define RDS_GROUP_2A 1 /**< Radio Text */
+#define RDS_GROUP_UNKNOWN 2 /**< Any other group type */
+
+/* Status codes returned by the functions below */
+enum rds_status {
+  RDS_OK = 0,                        /**< Success */
+  RDS_ERROR_CRC,                     /**< A block matches no offset word */
+  RDS_ERROR_EMPTY,                   /**< No group holds data */
+  RDS_ERROR_UNSUPPORTED_GROUP,       /**< Group type other than 0A or 2A */
+  RDS_ERROR_INCONSISTENT_PI,         /**< Groups of one message differ in PI */
+  RDS_ERROR_INCONSISTENT_GROUP_TYPE, /**< Groups of one message differ in type */
+  RDS_ERROR_INCONSISTENT_TP,         /**< Groups of one message differ in TP */
+  RDS_ERROR_INCONSISTENT_PTY,        /**< Groups of one message differ in PTY */
+  RDS_ERROR_INCONSISTENT_TA,         /**< Groups of one message differ in TA */
+  RDS_ERROR_INCONSISTENT_MS,         /**< Groups of one message differ in MS */
+  RDS_ERROR_INVALID_CHARACTER,       /**< Text input holds other than '0'/'1' */
+  RDS_ERROR_BUFFER_TOO_SMALL,        /**< Output buffer cannot hold the result */
+  RDS_ERROR_DUPLICATE_BLOCK,         /**< Two blocks of a group carry the same offset word */
+  RDS_ERROR_INVALID_LENGTH           /**< Text input is not a whole number of blocks */
+};
+
+/** Settings of a 0A message. */
+typedef struct rds_0a_config {
+  uint16_t pi;              /**< Program Identification */
+  uint8_t pty;              /**< Program Type (0-31) */
+  uint8_t tp;               /**< Traffic Program flag */
+  uint8_t ms;               /**< Music/Speech flag */
+  uint8_t ta;               /**< Traffic Announcement flag */
+  uint8_t af1;              /**< Alternative Frequency #1, RDS 8-bit code */
+  uint8_t af2;              /**< Alternative Frequency #2, RDS 8-bit code */
+  char ps[RDS_PS_LENGTH];   /**< Program Service name, space padded */
+} rds_0a_config;
+
+/** Settings of a 2A message. */
+typedef struct rds_2a_config {
+  uint16_t pi;              /**< Program Identification */
+  uint8_t pty;              /**< Program Type (0-31) */
+  uint8_t tp;               /**< Traffic Program flag */
+  uint8_t ab;               /**< Radio Text A/B flag */
+  char rt[RDS_RT_LENGTH];   /**< Radio Text, space padded or ended by RDS_RT_END */
+} rds_2a_config;
+
+/** Settings of a 4A clock time message. */
+typedef struct rds_4a_config {
+  uint16_t pi;              /**< Program Identification */
+  uint8_t pty;              /**< Program Type (0-31) */
+  uint8_t tp;               /**< Traffic Program flag */
+  uint32_t mjd;             /**< Modified Julian Day (17 bits) */
+  uint8_t hour;             /**< UTC hour (0-23) */
+  uint8_t minute;           /**< UTC minute (0-59) */
+  int8_t local_offset;      /**< Local time offset in half hours (-31 to 31) */
+} rds_4a_config;
+
+/** Fields of a decoded message. Characters never received are '_'. */
+typedef struct rds_decoded {
+  uint8_t group_type;            /**< RDS_GROUP_0A or RDS_GROUP_2A */
+  uint16_t pi;                   /**< Program Identification */
+  uint8_t tp;                    /**< Traffic Program flag */
+  uint8_t pty;                   /**< Program Type */
+  uint8_t ta;                    /**< Traffic Announcement flag (0A) */
+  uint8_t ms;                    /**< Music/Speech flag (0A) */
+  uint8_t di;                    /**< Decoder Identification bit (0A) */
+  uint8_t af1;                   /**< Alternative Frequency #1 code (0A) */
+  uint8_t af2;                   /**< Alternative Frequency #2 code (0A) */
+  uint8_t ab;                    /**< Radio Text A/B flag (2A) */
+  char ps[RDS_PS_LENGTH + 1];    /**< Program Service name (0A), terminated */
+  char rt[RDS_RT_LENGTH + 1];    /**< Radio Text (2A), terminated, cut at RDS_RT_END */
+} rds_decoded;
+
+/**
+ * Reassembles one message segment by segment. Every group updates the
+ * characters of its segment and a bitmap of received segments, so no group
+ * is stored and a message is complete as soon as its last segment arrives.
+ * The type of the first group decides the message type and how later groups
+ * are placed; it must be initialized with rds_assembler_init() before use.
+ */
+typedef struct rds_assembler {
+  int group_type;       /**< Message type, -1 until the first group */
+  uint16_t present;     /**< Bitmask of received segments */
+  uint8_t first_segment; /**< Lowest received segment, source of DI, AF and A/B */
+  uint8_t segments;     /**< Segments of the message, fewer once RDS_RT_END arrives */
+  int status;           /**< First inconsistency between groups, RDS_OK if none */
+  rds_decoded message;  /**< Message received so far */
+} rds_assembler;
+
+/**
+ * Encodes a 0A message.
+ * @param config Settings of the message.
+ * @param blocks Output, RDS_0A_BLOCKS blocks in transmission order.
+ * @param capacity Number of blocks that fit into blocks.
+ * @return Number of blocks written, 0 if capacity is too small.
+ */
+size_t rds_encode_0a(const rds_0a_config *config, uint32_t *blocks, size_t capacity);
+
+/**
+ * Encodes one block of a 0A message, e.g. to re-encode only the blocks
+ * whose fields changed. rds_encode_0a() writes these blocks in order.
+ * @param config Settings of the message.
+ * @param index Index of the block in the message (0 to RDS_0A_BLOCKS - 1).
+ * @return The block with its checkword.
+ */
+uint32_t rds_encode_0a_block(const rds_0a_config *config, unsigned index);
+
+/**
+ * Returns the number of 2A groups a Radio Text needs: up to the segment
+ * holding the first RDS_RT_END, all 16 if there is none.
+ * @param config Settings of the message.
+ * @return Number of segments (1-16).
+ */
+unsigned rds_rt_segments(const rds_2a_config *config);
+
+/**
+ * Encodes a 2A message. A Radio Text ended by RDS_RT_END is only encoded
+ * up to the segment holding it, see rds_rt_segments().
+ * @param config Settings of the message.
+ * @param blocks Output, up to RDS_2A_BLOCKS blocks in transmission order.
+ * @param capacity Number of blocks that fit into blocks, at least RDS_2A_BLOCKS.
+ * @return Number of blocks written, 0 if capacity is too small.
+ */
+size_t rds_encode_2a(const rds_2a_config *config, uint32_t *blocks, size_t capacity);
+
+/**
+ * Encodes one block of a 2A message, e.g. to re-encode only the blocks
+ * whose fields changed. rds_encode_2a() writes these blocks in order.
+ * @param config Settings of the message.
+ * @param index Index of the block in the message (0 to RDS_2A_BLOCKS - 1).
+ * @return The block with its checkword.
+ */
+uint32_t rds_encode_2a_block(const rds_2a_config *config, unsigned index);
+
+/**
+ * Encodes a 4A clock time message.
+ * @param config Settings of the message.
+ * @param blocks Output, RDS_4A_BLOCKS blocks in transmission order.
+ * @param capacity Number of blocks that fit into blocks.
+ * @return Number of blocks written, 0 if capacity is too small.
+ */
+size_t rds_encode_4a(const rds_4a_config *config, uint32_t *blocks, size_t capacity);
+
+/**
+ * Converts blocks into '0'/'1' characters.
+ * @param blocks The blocks.
+ * @param count Number of blocks.
+ * @param text Output, 26 characters per block, not terminated.
+ * @param capacity Number of characters that fit into text.
+ * @return Number of characters written, 0 if capacity is too small.
+ */
+size_t rds_blocks_to_ascii(const uint32_t *blocks, size_t count, char *text, size_t capacity);
+
+/**
+ * Converts '0'/'1' characters into blocks, 26 characters per block.
+ * @param text The characters.
+ * @param length Number of characters, a multiple of 26.
+ * @param blocks Output blocks.
+ * @param capacity Number of blocks that fit into blocks.
+ * @param count Number of blocks written, or on RDS_ERROR_INVALID_CHARACTER
+ *        the index of the first invalid character.
+ * @return RDS_OK, RDS_ERROR_INVALID_LENGTH, RDS_ERROR_INVALID_CHARACTER or
+ *         RDS_ERROR_BUFFER_TOO_SMALL.
+ */
+int rds_ascii_to_blocks(const char *text, size_t length, uint32_t *blocks, size_t capacity, size_t *count);
+
+/**
+ * Puts the blocks of one received group into A, B, C, D order by their
+ * offset words. Blocks that match no offset are repaired if correct is set,
+ * assuming they were received in transmission order.
+ * @param in The received group.
+ * @param correct Non-zero to repair burst errors.
+ * @param out The group in A, B, C, D order; positions no block claimed are 0.
+ * @param bad_blocks Optional output, bitmask of blocks of in that match no
+ *        offset even after correction.
+ * @return RDS_OK, RDS_ERROR_CRC, or RDS_ERROR_DUPLICATE_BLOCK if two blocks
+ *         claim the same position, which leaves another one empty.
+ */
+int rds_sort_group(const uint32_t *in, int correct, uint32_t *out, uint8_t *bad_blocks);
+
+/**
+ * Clears an assembler.
+ * @param assembler The assembler.
+ */
+void rds_assembler_init(rds_assembler *assembler);
+
+/**
+ * Updates the segment of a group sorted by rds_sort_group() and checks the
+ * fields shared by all groups against the first group received.
+ * @param assembler The assembler.
+ * @param group The group in A, B, C, D order.
+ * @return RDS_OK, or RDS_ERROR_UNSUPPORTED_GROUP if the first group of the
+ *         message is neither 0A nor 2A, in which case group_type is
+ *         RDS_GROUP_UNKNOWN and every later group is refused as well.
+ */
+int rds_assembler_push(rds_assembler *assembler, const uint32_t *group);
+
+/**
+ * Tells whether every segment of the message has been received, with one
+ * population count of the segment bitmap. A Radio Text is complete once the
+ * segments up to the one holding RDS_RT_END have been received.
+ * @param assembler The assembler.
+ * @return Non-zero if the message is complete.
+ */
+int rds_assembler_complete(const rds_assembler *assembler);
+
+/**
+ * Returns the message received so far, unless the groups disagree in a
+ * field they all share.
+ * @param assembler The assembler.
+ * @param out The decoded message.
+ * @return RDS_OK, RDS_ERROR_EMPTY or one of the RDS_ERROR_INCONSISTENT_* codes.
+ */
+int rds_assembler_decode(const rds_assembler *assembler, rds_decoded *out);
+
+/**
+ * Decodes a whole capture of aligned groups: sorts every group, collects
+ * them and decodes the message. Groups of all zero blocks and groups of
+ * types other than 0A and 2A are skipped.
+ * @param blocks The blocks, 4 per group.
+ * @param count Number of blocks.
+ * @param correct Non-zero to repair burst errors and skip groups that
+ *        cannot be repaired instead of failing.
+ * @param out The decoded message.
+ * @return RDS_OK or an error code.
+ */
+int rds_decode(const uint32_t *blocks, size_t count, int correct, rds_decoded *out);
+
+/**
+ * Describes a status code.
+ * @param status The status code.
+ * @return Static message, e.g. "Inconsistent PI value across blocks".
+ */
+const char *rds_status_message(int status);
+
+#ifdef __cplusplus
+}
+#endif
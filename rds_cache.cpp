@@ -0,0 +1,85 @@
+/**
+ * @file       rds_cache.cpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Per-station cache of encoded blocks for incremental re-encoding
+ *
+ * @date      17 October  2026 \n
+ */
+
+#include "rds_cache.hpp"
+
+/* Blocks at the same position of every group of a message, A to D */
+constexpr uint16_t blocks_0A_A = 0x1111;
+constexpr uint16_t blocks_0A_B = 0x2222;
+constexpr uint64_t blocks_2A_A = 0x1111111111111111;
+constexpr uint64_t blocks_2A_B = 0x2222222222222222;
+
+BlockCache::BlockCache()
+    : ps(), rt(), dirty_0A(0xFFFF), dirty_2A(~uint64_t{0}), rt_segments(RDS_2A_BLOCKS / RDS_GROUP_BLOCKS), encoded(0), blocks_0A(), blocks_2A() {}
+
+bool BlockCache::update_0a(const rds_0a_config &config) {
+  uint16_t dirty = 0;
+  if (config.pi != ps.pi) dirty |= blocks_0A_A;
+  if (config.pty != ps.pty || config.tp != ps.tp || config.ta != ps.ta || config.ms != ps.ms) dirty |= blocks_0A_B;
+  // only the first group carries alternative frequencies
+  if (config.af1 != ps.af1 || config.af2 != ps.af2) dirty |= 1 << 2;
+  for (unsigned s = 0; s < 4; s++) {
+    if (config.ps[s * 2] != ps.ps[s * 2] || config.ps[s * 2 + 1] != ps.ps[s * 2 + 1]) dirty |= static_cast<uint16_t>(1 << (s * 4 + 3));
+  }
+  ps = config;
+  dirty_0A |= dirty;
+  return dirty != 0;
+}
+
+bool BlockCache::update_2a(const rds_2a_config &config) {
+  uint64_t dirty = 0;
+  if (config.pi != rt.pi) dirty |= blocks_2A_A;
+  if (config.pty != rt.pty || config.tp != rt.tp || config.ab != rt.ab) dirty |= blocks_2A_B;
+  for (unsigned s = 0; s < 16; s++) {
+    const char *before = rt.rt + s * 4;
+    const char *after = config.rt + s * 4;
+    if (after[0] != before[0] || after[1] != before[1]) dirty |= uint64_t{1} << (s * 4 + 2);
+    if (after[2] != before[2] || after[3] != before[3]) dirty |= uint64_t{1} << (s * 4 + 3);
+  }
+  rt = config;
+  rt_segments = rds_rt_segments(&config);
+  // blocks past the end of the text stay dirty until it grows again
+  dirty_2A |= dirty;
+  return dirty != 0;
+}
+
+const uint32_t *BlockCache::blocks_0a() {
+  if (dirty_0A) encode_0a();
+  return blocks_0A;
+}
+
+const uint32_t *BlockCache::blocks_2a() {
+  if (dirty_2A & rt_blocks()) encode_2a();
+  return blocks_2A;
+}
+
+uint64_t BlockCache::rt_blocks() const { return rt_segments == 16 ? ~uint64_t{0} : (uint64_t{1} << (rt_segments * 4)) - 1; }
+
+void BlockCache::encode_0a() {
+  for (unsigned i = 0; i < RDS_0A_BLOCKS; i++) {
+    if (!(dirty_0A & (1 << i))) continue;
+    blocks_0A[i] = rds_encode_0a_block(&ps, i);
+    encoded++;
+  }
+  dirty_0A = 0;
+}
+
+void BlockCache::encode_2a() {
+  uint64_t needed = rt_blocks();
+  for (unsigned i = 0; i < RDS_2A_BLOCKS; i++) {
+    if (!(dirty_2A & needed & (uint64_t{1} << i))) continue;
+    blocks_2A[i] = rds_encode_2a_block(&rt, i);
+    encoded++;
+  }
+  dirty_2A &= ~needed;
+}
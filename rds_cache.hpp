@@ -0,0 +1,87 @@
+/**
+ * @file       rds_cache.hpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Per-station cache of encoded blocks for incremental re-encoding
+ *
+ * @date      17 October  2026 \n
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "rds.h"
+
+/**
+ * The encoded PS (0A) and RT (2A) messages of one station. An update
+ * compares the new configuration with the cached one and only marks the
+ * blocks whose fields changed; those are re-encoded, checkword included,
+ * the next time the message is read. A new RT therefore costs the C and D
+ * blocks of the segments whose characters differ, a new PI only the A
+ * blocks. Each block is encoded by rds_encode_0a_block() or
+ * rds_encode_2a_block(), so the messages are identical to rds_encode_0a()
+ * and rds_encode_2a(), and an RT ended by RDS_RT_END only has the segments
+ * up to it.
+ */
+class BlockCache {
+public:
+  /** Constructor for BlockCache, both messages start empty. */
+  BlockCache();
+
+  /**
+   * Updates the PS message.
+   * @param config The new configuration.
+   * @return Whether any block changed.
+   */
+  bool update_0a(const rds_0a_config &config);
+
+  /**
+   * Updates the RT message.
+   * @param config The new configuration.
+   * @return Whether any block changed.
+   */
+  bool update_2a(const rds_2a_config &config);
+
+  /**
+   * Returns the PS message, re-encoding the blocks changed since the last call.
+   * @return RDS_0A_BLOCKS blocks in transmission order.
+   */
+  const uint32_t *blocks_0a();
+
+  /**
+   * Returns the RT message, re-encoding the blocks changed since the last call.
+   * @return 4 * segments_2a() blocks in transmission order.
+   */
+  const uint32_t *blocks_2a();
+
+  /** Returns the number of groups of the RT message, see rds_rt_segments(). */
+  unsigned segments_2a() const { return rt_segments; }
+
+  /** Returns the number of blocks encoded so far. */
+  uint64_t get_encoded() const { return encoded; }
+
+private:
+  /** Returns the bitmask of the RT blocks that are sent. */
+  uint64_t rt_blocks() const;
+
+  /** Re-encodes the dirty blocks of the PS message. */
+  void encode_0a();
+
+  /** Re-encodes the dirty blocks of the RT message. */
+  void encode_2a();
+
+  rds_0a_config ps;                  /**< Configuration of the PS message */
+  rds_2a_config rt;                  /**< Configuration of the RT message */
+  uint16_t dirty_0A;                 /**< Bitmask of PS blocks to re-encode */
+  uint64_t dirty_2A;                 /**< Bitmask of RT blocks to re-encode */
+  unsigned rt_segments;              /**< Groups of the RT message */
+  uint64_t encoded;                  /**< Number of blocks encoded */
+  uint32_t blocks_0A[RDS_0A_BLOCKS]; /**< Encoded PS message */
+  uint32_t blocks_2A[RDS_2A_BLOCKS]; /**< Encoded RT message */
+};
@@ -0,0 +1,111 @@
+/**
+ * @file       rds_channel.cpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Simulation of a noisy reception channel at the bit level
+ *
+ * @date      17 October  2026 \n
+ */
+
+#include "rds_channel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+Channel::Channel(const ChannelConfig &config)
+    : config(config), state(config.seed * 0x9E3779B97F4A7C15ull + 1), position(0), next_flip(0), next_burst(0), next_slip(0),
+      next_dropout(0), burst_left(0), dropout_left(0), stats() {
+  next_flip = next_event(config.bit_error_rate);
+  next_burst = next_event(config.burst_rate);
+  next_slip = next_event(config.slip_rate);
+  next_dropout = next_event(config.dropout_rate);
+}
+
+uint64_t Channel::next_random() {
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return state * 0x2545F4914F6CDD1Dull;
+}
+
+uint64_t Channel::next_event(double rate) {
+  if (rate <= 0) return UINT64_MAX;
+  // uniform in (0, 1], its logarithm over log(1 - rate) is the geometric gap
+  double uniform = (static_cast<double>(next_random() >> 11) + 1) / 9007199254740992.0;
+  double gap = rate >= 1 ? 0 : std::floor(std::log(uniform) / std::log1p(-rate));
+  if (gap >= static_cast<double>(UINT64_MAX - position - 1)) return UINT64_MAX;
+  return position + 1 + static_cast<uint64_t>(gap);
+}
+
+unsigned Channel::transmit(uint32_t block, BlockWriter &writer, unsigned &flipped) {
+  flipped = 0;
+  uint64_t end = position + 26;
+  stats.bits_in += 26;
+  if (burst_left == 0 && dropout_left == 0 && std::min(std::min(next_flip, next_burst), std::min(next_slip, next_dropout)) >= end) {
+    writer.write_block(block);
+    position = end;
+    stats.bits_out += 26;
+    return 0;
+  }
+
+  unsigned events = 0;
+  uint32_t out = 0;
+  unsigned count = 0;
+  for (unsigned i = 26; i-- > 0; position++) {
+    uint32_t bit = (block >> i) & 1;
+    uint32_t received = bit;
+    unsigned copies = 1;
+
+    if (position == next_dropout) {
+      dropout_left = 1 + static_cast<unsigned>(next_random() % std::max(config.dropout_length, 1u));
+      next_dropout = next_event(config.dropout_rate);
+      stats.dropouts++;
+    }
+    if (position == next_burst) {
+      burst_left = 1 + static_cast<unsigned>(next_random() % std::max(config.burst_length, 1u));
+      next_burst = next_event(config.burst_rate);
+      stats.bursts++;
+    }
+    if (burst_left > 0) {
+      received ^= static_cast<uint32_t>(next_random() >> 63);
+      burst_left--;
+      events |= EVENT_BURST;
+    }
+    if (position == next_flip) {
+      received ^= 1;
+      next_flip = next_event(config.bit_error_rate);
+      events |= EVENT_FLIP;
+    }
+    if (dropout_left > 0) {
+      // the receiver only hears noise, which is not counted as bit errors
+      received = static_cast<uint32_t>(next_random() >> 63);
+      dropout_left--;
+      events |= EVENT_DROPOUT;
+    } else if (received != bit) {
+      flipped++;
+    }
+    if (position == next_slip) {
+      copies = static_cast<unsigned>(next_random() >> 63) * 2;
+      next_slip = next_event(config.slip_rate);
+      stats.slips++;
+      events |= EVENT_SLIP;
+    }
+
+    for (unsigned c = 0; c < copies; c++) {
+      out = (out << 1) | received;
+      if (++count == 26) {
+        writer.write_block(out);
+        out = 0;
+        count = 0;
+      }
+    }
+    stats.bits_out += copies;
+  }
+  if (count > 0) writer.write_bits(out, count);
+  stats.flipped += flipped;
+  return events;
+}
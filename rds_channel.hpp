@@ -0,0 +1,99 @@
+/**
+ * @file       rds_channel.hpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Simulation of a noisy reception channel at the bit level
+ *
+ * @date      17 October  2026 \n
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bitstream.hpp"
+
+/* Impairments of a channel, rates are per transmitted bit */
+struct ChannelConfig {
+  double bit_error_rate;   /**< Probability of an independent bit flip */
+  double burst_rate;       /**< Probability of a burst starting */
+  unsigned burst_length;   /**< Longest burst in bits, each bit of it flips with probability 1/2 */
+  double slip_rate;        /**< Probability of a bit slip, a bit lost or repeated */
+  double dropout_rate;     /**< Probability of a dropout starting */
+  unsigned dropout_length; /**< Longest dropout in bits, replaced by random bits */
+  uint64_t seed;           /**< Seed of the pseudo-random generator */
+};
+
+/* Damage done to one block */
+enum ChannelEvent {
+  EVENT_FLIP = 1,    /**< Independent bit errors */
+  EVENT_BURST = 2,   /**< Part of a burst */
+  EVENT_SLIP = 4,    /**< A bit lost or repeated */
+  EVENT_DROPOUT = 8  /**< Part of a dropout */
+};
+
+/* Totals of a channel */
+struct ChannelStats {
+  uint64_t bits_in;  /**< Bits transmitted */
+  uint64_t bits_out; /**< Bits received */
+  uint64_t flipped;  /**< Bits received inverted, dropouts excluded */
+  uint64_t bursts;   /**< Bursts started */
+  uint64_t slips;    /**< Bits lost or repeated */
+  uint64_t dropouts; /**< Dropouts started */
+};
+
+/**
+ * Passes blocks to a BlockWriter, damaging them on the way like a weak or
+ * fading signal. Every impairment is a Poisson process over the transmitted
+ * bits: the distance to its next event is drawn from the geometric
+ * distribution, so a block far from every event is written in one piece
+ * and only the blocks an event touches are walked bit by bit. The same
+ * seed always gives the same damage.
+ */
+class Channel {
+public:
+  /**
+   * Constructor for Channel.
+   * @param config The impairments.
+   */
+  explicit Channel(const ChannelConfig &config);
+
+  /**
+   * Sends a block through the channel.
+   * @param block The block.
+   * @param writer Receives the damaged bits.
+   * @param flipped Output, number of bits of the block received inverted.
+   * @return Bitmask of the ChannelEvent values that touched the block.
+   */
+  unsigned transmit(uint32_t block, BlockWriter &writer, unsigned &flipped);
+
+  /** Returns the totals. */
+  const ChannelStats &get_stats() const { return stats; }
+
+private:
+  /** Returns the next pseudo-random number, xorshift64*. */
+  uint64_t next_random();
+
+  /**
+   * Returns the position of the next event of a Poisson process.
+   * @param rate Probability of an event per bit.
+   * @return A position after the current one, UINT64_MAX if rate is 0.
+   */
+  uint64_t next_event(double rate);
+
+  ChannelConfig config;  /**< The impairments */
+  uint64_t state;        /**< State of the pseudo-random generator */
+  uint64_t position;     /**< Index of the next transmitted bit */
+  uint64_t next_flip;    /**< Position of the next independent bit error */
+  uint64_t next_burst;   /**< Position of the next burst */
+  uint64_t next_slip;    /**< Position of the next bit slip */
+  uint64_t next_dropout; /**< Position of the next dropout */
+  unsigned burst_left;   /**< Bits left of the current burst */
+  unsigned dropout_left; /**< Bits left of the current dropout */
+  ChannelStats stats;    /**< Totals */
+};
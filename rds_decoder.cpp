@@ -13,125 +13,261 @@
 
 #include "rds_decoder.hpp"
 
-GroupType get_group(uint32_t block) {
-  std::bitset<26> group_0A_bitset = group_type_code_0A << 21;
-  std::bitset<26> group_2A_bitset = group_type_code_2A << 21;
-  std::bitset<26> group_mask_bitset = group_type_mask << 21;
-  std::bitset<26> block_bitset = block;
-
-  // mask the first 21 bits
-  std::bitset<26> block_bitset_masked = block_bitset & group_mask_bitset;
-
-  if ((group_0A_bitset | block_bitset_masked) == group_0A_bitset) {
-    return GROUP_0A;
-  } else if ((group_2A_bitset | block_bitset_masked) == group_2A_bitset) {
-    return GROUP_2A;
-  } else {
-    return UNKNOWN;
+#include <fcntl.h>
+#include <unistd.h>
+
+const char *helpMessage = R"(
+Usage: ./rds_decoder -b BINARY_STRING [--sync] [--max-bad N] [--correct] [--stations] [--metrics FILE]
+       ./rds_decoder --stream [FILE] [--format ascii|packed|wav|f32|cu8|cs16|cf32] [--rate N] [--max-bad N] [--correct] [--stations]
+                     [--metrics FILE] [--metrics-interval N] [--monitor N] [--alert-bler P]
+
+Description:
+  This program decodes RDS data from a binary string and display the information for Group 0A or 2A.
+
+Options:
+  -b STRING    Binary string of whole groups (a multiple of 104 bits).
+  --sync       Accept a string of any length that may start mid-block; block
+               boundaries are found from the offset words.
+  --max-bad N  With --sync, consecutive bad blocks after which sync is lost
+               and searched for again (default: 4).
+  --stream     Read the bits from FILE, or standard input if no file is
+               given, in fixed-size chunks. Block boundaries are found as
+               with --sync, whitespace is ignored and every PS or RT message
+               is printed as soon as all of its segments have been received.
+  --format F   Format of the stream: ascii (default, one character per bit),
+               packed (bits packed MSB-first into bytes, as written by
+               rds_encoder --format packed), or the FM multiplex signal
+               with the 57 kHz subcarrier as wav (16-bit or float PCM) or
+               f32 (raw 32-bit float samples). The signal is demodulated:
+               the carrier is recovered without the 19 kHz pilot, and bit
+               timing and polarity are found from the signal itself.
+               cu8, cs16 and cf32 are raw IQ captures of an SDR receiver
+               tuned to the station (interleaved unsigned 8-bit, 16-bit or
+               float I/Q), which are FM demodulated first.
+  --rate N     Sample rate of the f32 and IQ formats in Hz, 128000 to 3200000
+               (default: 228000). A WAV header carries its own.
+  --stations   Decode a capture that mixes several stations: every group is
+               sent to the station named by its PI code and a summary of
+               each station (PTY, flags, PS and RT) is printed at the end.
+  --correct    Repair burst errors of up to 5 bits per block. Groups with
+               uncorrectable blocks are reported and skipped instead of
+               failing the whole input.
+  --metrics F  Write decoder statistics to F at the end: blocks checked and
+               per offset word, CRC failures, corrected blocks, sync losses,
+               groups per type, distinct PI codes, decoded and inconsistent
+               messages, and the time spent in each stage.
+  --metrics-format json|prometheus
+               Format of the statistics (default: json); prometheus is the
+               text exposition format, e.g. for the node exporter textfile
+               collector.
+  --metrics-interval N
+               With --stream, also write the statistics every N seconds.
+  --monitor N  With --stream, print a status line every N seconds of stream
+               time (the bits received at 1187.5 bit/s) with the block
+               error rate over the last 100 groups, minute and ten minutes,
+               the share of repaired blocks and the sync state.
+  --alert-bler P
+               With --stream, print an alert line on stderr when the block
+               error rate of a window rises above P percent, and another
+               when it falls back.
+)";
+
+int ArgumentParser::sort_group(size_t index, uint32_t *sorted) {
+  uint8_t bad_blocks{};
+  const uint32_t *group = blocks.data() + index * 4;
+  // skip empty groups
+  if (is_group_empty(group)) return 1;
+  int status = rds_sort_group(group, correct, sorted, &bad_blocks);
+  // the synchronizer has counted the blocks of its groups
+  if (!synchronize) {
+    for (int j = 0; j < 4; j++) {
+      BlockOffset offset = get_block_offset(group[j]);
+      count_block(offset);
+      if (bad_blocks & (1 << j)) count_metric(METRIC_CRC_FAILURES);
+      else if (offset == OFFSET_INVALID) count_metric(METRIC_CORRECTED);
+    }
+  }
+  if (status == RDS_OK) {
+    count_group(sorted);
+    return 0;
+  }
+  if (status == RDS_ERROR_DUPLICATE_BLOCK) {
+    std::cerr << rds_status_message(status) << " in group " << index << std::endl;
+    return correct ? 1 : 2;
   }
+  // if no CRC passes return error
+  if (!correct) return 2;
+  for (int j = 0; j < 4; j++) {
+    if (bad_blocks & (1 << j)) std::cerr << "Uncorrectable block " << j << " in group " << index << std::endl;
+  }
+  return 1;
 }
 
-bool is_group_empty(std::vector<uint32_t>& data, int idx) {
-  // unpack each block and check if they are zero
-  uint32_t b0 = data[idx * 4];
-  uint32_t b1 = data[idx * 4 + 1];
-  uint32_t b2 = data[idx * 4 + 2];
-  uint32_t b3 = data[idx * 4 + 3];
+int ArgumentParser::sort_blocks(rds_assembler &assembler) {
+  StageTimer timer(STAGE_DECODE);
+  uint32_t sorted[RDS_GROUP_BLOCKS];
+  unsigned skipped = 0;
 
-  if (!b0 && !b1 && !b2 && !b3) return true;
-  return false;
+  // iterate over groups
+  for (size_t i = 0; i < blocks.size() / 4; i++) {
+    int ret = sort_group(i, sorted);
+    if (ret == 2) return 2;
+    if (ret != 0) continue;
+    // groups of other types are counted and skipped
+    if (get_group(sorted[1]) == UNKNOWN) {
+      skipped++;
+      continue;
+    }
+    rds_assembler_push(&assembler, sorted);
+  }
+  if (skipped) std::cerr << "Skipped " << skipped << " groups of unsupported types" << std::endl;
+  // only unsupported groups are reported once every group is checked
+  if (assembler.group_type == -1 && !skipped) return 2;
+  return 0;
 }
 
-int get_block_addr(uint32_t block) {
-  uint32_t check_crc{};
-  check_crc = crc((block & inv_crc_mask), offset_A);
-  if (check_crc == (block & crc_mask)) return 0;
-
-  check_crc = crc((block & inv_crc_mask), offset_B);
-  if (check_crc == (block & crc_mask)) return 1;
-
-  check_crc = crc((block & inv_crc_mask), offset_C);
-  if (check_crc == (block & crc_mask)) return 2;
-
-  check_crc = crc((block & inv_crc_mask), offset_D);
-  if (check_crc == (block & crc_mask)) return 3;
+int ArgumentParser::collect_stations(StationTable &table) {
+  StageTimer timer(STAGE_DECODE);
+  uint32_t sorted[RDS_GROUP_BLOCKS];
 
-  return -1;
+  for (size_t i = 0; i < blocks.size() / 4; i++) {
+    int ret = sort_group(i, sorted);
+    if (ret == 2) return 2;
+    if (ret == 0) table.push_group(sorted);
+  }
+  return table.get_stations().empty() ? 2 : 0;
 }
 
-int ArgumentParser::sort_blocks() {
-  std::vector<uint32_t> output_data(blocks.size());
-  
-  int block_addr{};
+ArgumentParser::ArgumentParser(int argc, char *argv[])
+    : error(NO_ERROR), synchronize(false), max_bad_blocks(default_max_bad_blocks), correct(false), stream(false), format(FORMAT_ASCII),
+      sample_rate(default_sample_rate), stations(false), metrics_format(METRICS_JSON), metrics_interval(0),
+      monitor_interval(0), alert_threshold(-1) {
+  if (argc < 2) {
+    error = ARGUMENT_COUNT;
+    std::cout << helpMessage;
+    return;
+  }
 
-  // iterate over groups
-  for (int i = 0; i < static_cast<int>(blocks.size()) / 4; i ++) {
-    // skip empty groups
-    if (is_group_empty(blocks, i)) continue;
-    uint32_t block;
-    for (int j = 0; j < 4; j++) {
-      block = blocks[i * 4 + j];
-      block_addr = get_block_addr(block);
-      // if no CRC passes return error
-      if (block_addr == -1) return 2;
-      output_data[i * 4 + block_addr] = block;
+  bool has_binary_string = false;
+  for (int i = 1; i < argc; i++) {
+    std::string flag = argv[i];
+    if (flag == "-b" && i + 1 < argc) {
+      binary_string_value = argv[++i];
+      has_binary_string = true;
+    } else if (flag == "--sync") {
+      synchronize = true;
+    } else if (flag == "--correct") {
+      correct = true;
+    } else if (flag == "--stations") {
+      stations = true;
+    } else if (flag == "--stream") {
+      stream = true;
+      // the file is optional, flags never name one
+      if (i + 1 < argc && std::string(argv[i + 1]).compare(0, 1, "-") != 0) stream_path = argv[++i];
+    } else if (flag == "--format" && i + 1 < argc) {
+      if (parse_format(argv[++i], format)) {
+        std::cout << "Invalid format: " << argv[i] << std::endl;
+        error = INVALID_VALUE;
+        return;
+      }
+    } else if (flag == "--rate" && i + 1 < argc) {
+      std::string value = argv[++i];
+      if (value.empty() || value.size() > 7 || value.find_first_not_of("0123456789") != std::string::npos ||
+          std::stoul(value) < min_sample_rate || std::stoul(value) > max_sample_rate) {
+        std::cout << "Invalid value for --rate: " << value << std::endl;
+        error = INVALID_VALUE;
+        return;
+      }
+      sample_rate = static_cast<unsigned>(std::stoul(value));
+    } else if (flag == "--metrics" && i + 1 < argc) {
+      metrics_path = argv[++i];
+    } else if (flag == "--metrics-format" && i + 1 < argc) {
+      if (parse_metric_format(argv[++i], metrics_format)) {
+        std::cout << "Invalid value for --metrics-format: " << argv[i] << std::endl;
+        error = INVALID_VALUE;
+        return;
+      }
+    } else if (flag == "--metrics-interval" && i + 1 < argc) {
+      std::string value = argv[++i];
+      if (value.empty() || value.size() > 5 || value.find_first_not_of("0123456789") != std::string::npos || std::stoi(value) == 0) {
+        std::cout << "Invalid value for --metrics-interval: " << value << std::endl;
+        error = INVALID_VALUE;
+        return;
+      }
+      metrics_interval = static_cast<unsigned>(std::stoi(value));
+    } else if (flag == "--monitor" && i + 1 < argc) {
+      std::string value = argv[++i];
+      if (value.empty() || value.size() > 5 || value.find_first_not_of("0123456789") != std::string::npos || std::stoi(value) == 0) {
+        std::cout << "Invalid value for --monitor: " << value << std::endl;
+        error = INVALID_VALUE;
+        return;
+      }
+      monitor_interval = static_cast<unsigned>(std::stoi(value));
+    } else if (flag == "--alert-bler" && i + 1 < argc) {
+      std::string value = argv[++i];
+      if (value.empty() || value.size() > 8 || value.find_first_not_of("0123456789.") != std::string::npos ||
+          value.find('.') != value.rfind('.') || value == "." || std::stod(value) > 100) {
+        std::cout << "Invalid value for --alert-bler: " << value << std::endl;
+        error = INVALID_VALUE;
+        return;
+      }
+      alert_threshold = std::stod(value);
+    } else if (flag == "--max-bad" && i + 1 < argc) {
+      std::string value = argv[++i];
+      if (value.empty() || value.size() > 4 || value.find_first_not_of("0123456789") != std::string::npos || std::stoi(value) == 0) {
+        std::cout << "Invalid value for --max-bad: " << value << std::endl;
+        error = INVALID_VALUE;
+        return;
+      }
+      max_bad_blocks = static_cast<unsigned>(std::stoi(value));
+    } else {
+      std::cout << "Invalid flag: " << argv[i] << std::endl;
+      error = INVALID_FLAG;
+      return;
     }
   }
-  blocks = output_data;
-  return 0;
-}
 
-void Group2A::sort_2A_data() {
-  // 16 groups of 4 blocks, initiated to 0
-  std::vector<uint32_t> output_data(16 * 4);
-  
-  // iterate over 4 groups
-  for (int i = 0; i <  static_cast<int>(mData.size()) / 4; i++) {
-    // look into the 2nd block of each group
-    uint32_t second_block = mData[i * 4 + 1];
-    uint8_t segment_address = (second_block & segment_mask_2A) >> 10;
-    // assign to the correct address in the output
-    output_data[segment_address * 4] = mData[i * 4];
-    output_data[segment_address * 4 + 1] = mData[i * 4 + 1];
-    output_data[segment_address * 4 + 2] = mData[i * 4 + 2];
-    output_data[segment_address * 4 + 3] = mData[i * 4 + 3];
+  if (stream) {
+    if (has_binary_string) {
+      std::cout << "Invalid flag: -b cannot be combined with --stream" << std::endl;
+      error = INVALID_FLAG;
+    }
+    return;
   }
 
-  mData = output_data;
-}
+  if (format != FORMAT_ASCII) {
+    std::cout << "Invalid flag: --format requires --stream" << std::endl;
+    error = INVALID_FLAG;
+    return;
+  }
 
-void Group0A::sort_0A_data() {
-  // 4 groups of 4 blocks, initiated to 0
-  std::vector<uint32_t> output_data(4 * 4);
-  
-  // iterate over groups (each group has 4 blocks)
-  for (int i = 0; i < static_cast<int>(mData.size()) / 4; i++) {
-    // look into the 2nd block of each group
-    uint32_t second_block = mData[i * 4 + 1];
-    uint8_t segment_address = (second_block & segment_mask_0A) >> 10;
-    // assign to the correct address in the output
-    output_data[segment_address * 4] = mData[i * 4];
-    output_data[segment_address * 4 + 1] = mData[i * 4 + 1];
-    output_data[segment_address * 4 + 2] = mData[i * 4 + 2];
-    output_data[segment_address * 4 + 3] = mData[i * 4 + 3];
+  if (metrics_interval) {
+    std::cout << "Invalid flag: --metrics-interval requires --stream" << std::endl;
+    error = INVALID_FLAG;
+    return;
   }
 
-  mData = output_data;
-}
+  if (monitor_interval || alert_threshold >= 0) {
+    std::cout << "Invalid flag: " << (monitor_interval ? "--monitor" : "--alert-bler") << " requires --stream" << std::endl;
+    error = INVALID_FLAG;
+    return;
+  }
 
-ArgumentParser::ArgumentParser(int argc, char *argv[]) : error(NO_ERROR) {
-  if (argc != 3) {
+  if (!has_binary_string) {
     error = ARGUMENT_COUNT;
     std::cout << helpMessage;
     return;
   }
 
-  if (std::string(argv[1]) != "-b") {
-    std::cout << "Invalid flag: " << argv[1] << std::endl;
-    error = INVALID_FLAG;
-    return;
+  if (synchronize) {
+    parse_synchronized();
+  } else {
+    parse_aligned();
   }
-  binary_string_value = argv[2];
+}
+
+void ArgumentParser::parse_aligned() {
+  StageTimer timer(STAGE_PARSE);
   if (binary_string_value.size() % 104 != 0 || !binary_string_value.size()) {
     std::cout << "Invalid length of binary value (length: " << binary_string_value.size() << ")"
               << std::endl;
@@ -139,242 +275,111 @@ ArgumentParser::ArgumentParser(int argc, char *argv[]) : error(NO_ERROR) {
     return;
   }
 
-  for (size_t g = 0; g < binary_string_value.size() / 104; g++) {
-    for (size_t i = 0; i < 4; i++) {
-      uint32_t value = 0;
-      for (size_t b = 0; b < 26; b++) {
-        char c = binary_string_value[(g * 104) + (i * 26) + b];
-        if (c != '0' && c != '1') {
-          std::cout << "Invalid character in binary value: " << c << std::endl;
-          error = INVALID_VALUE;
-          return;
-        }
-        value |= (c == '1') ? 0b1 : 0b0;
-        if (b < 25)
-          value <<= 1;
-      }
-      blocks.push_back(value);
-    }
+  blocks.resize(binary_string_value.size() / 26);
+  size_t invalid = parse_ascii_blocks(binary_string_value.data(), binary_string_value.size(), blocks.data());
+  if (invalid != binary_string_value.size()) {
+    std::cout << "Invalid character in binary value: " << binary_string_value[invalid] << std::endl;
+    error = INVALID_VALUE;
+    blocks.clear();
+    return;
   }
 }
 
-std::string format_frequency(uint32_t frequency) {
-  std::string freq_str = std::to_string(frequency + 875);
-  freq_str.insert(freq_str.size() - 1, ".");
-  return freq_str;
-}
+void ArgumentParser::parse_synchronized() {
+  if (!binary_string_value.size()) {
+    std::cout << "Invalid length of binary value (length: 0)" << std::endl;
+    error = INVALID_VALUE;
+    return;
+  }
 
-std::string trim_space_end(std::string input) {
-  std::string output;
-  bool trim = true;
-  for (int i = static_cast<int>(input.size()) - 1; i >= 0; i--) {
-    if (input[static_cast<size_t>(i)] != ' ')
-      trim = false;
-    if (!trim)
-      output.append(1, input[static_cast<size_t>(i)]);
+  StageTimer timer(STAGE_SYNCHRONIZE);
+  BlockSynchronizer synchronizer(max_bad_blocks, correct);
+  // a block per 26 bits at most, the groups never reallocate
+  blocks.reserve(binary_string_value.size() / 26);
+  unsigned group_index = 0;
+  for (char c : binary_string_value) {
+    if (c != '0' && c != '1') {
+      std::cout << "Invalid character in binary value: " << c << std::endl;
+      error = INVALID_VALUE;
+      return;
+    }
+    if (!synchronizer.push_bit(c == '1')) continue;
+    // keep only groups in which every block passed the check
+    if (synchronizer.group_complete()) {
+      blocks.insert(blocks.end(), synchronizer.group(), synchronizer.group() + 4);
+    } else if (correct) {
+      // blocks before the acquisition were never received
+      uint8_t failed = synchronizer.group_received() & ~synchronizer.group_valid();
+      for (int j = 0; j < 4; j++) {
+        if (failed & (1 << j)) std::cerr << "Uncorrectable block " << j << " in group " << group_index << std::endl;
+      }
+    }
+    group_index++;
   }
-  std::reverse(output.begin(), output.end());
-  return output;
 }
 
-int Group2A::parse() {
-  uint16_t tmp_pi{};
-  uint8_t tmp_gt_vc{};
-  bool tmp_tp{};
-  uint8_t tmp_pty{};
-  bool tmp_ab{};
-  uint8_t tmp_segment{};
-
-  uint8_t tmp_c1{};
-  uint8_t tmp_c2{};
-  uint8_t tmp_c3{};
-  uint8_t tmp_c4{};
-
-  uint32_t block{};
-  bool first_valid_group = true;
-
-  for (int group = 0; group < 16; group++) {
-    // if the group is empty, do not process it
-    if (is_group_empty(mData, group)) continue;
-
-    // block 0
-    block = mData[static_cast<size_t>(group) * 4];
-    tmp_pi = (block & pi_mask) >> 10;
-
-    // block 1
-    block = mData[static_cast<size_t>(group) * 4 + 1];
-    tmp_gt_vc = (block & gt_vc_mask) >> 21;
-    tmp_tp = (block & tp_mask) >> 20;
-    tmp_pty = (block & pty_mask) >> 15;
-    tmp_ab = (block & ta_mask) >> 14;
-    tmp_segment = (block & segment_mask_2A) >> 10;
-
-    // block 2
-    block = mData[static_cast<size_t>(group) * 4 + 2];
-    tmp_c1 = (block & c1_mask) >> 18;
-    tmp_c2 = (block & c2_mask) >> 10;
-    // fill the characters into the string
-    rt[group * 4] = static_cast<char>(tmp_c1);
-    rt[group * 4 + 1] = static_cast<char>(tmp_c2);
-
-    // block 3
-    block = mData[static_cast<size_t>(group) * 4 + 3];
-    tmp_c3 = (block & c1_mask) >> 18;
-    tmp_c4 = (block & c2_mask) >> 10;
-    // fill the characters into the string
-    rt[group * 4 + 2] = static_cast<char>(tmp_c3);
-    rt[group * 4 + 3] = static_cast<char>(tmp_c4);
-
-    // first group, save values
-    if (first_valid_group) {
-      first_valid_group = false;
-      pi = tmp_pi;
-      gt_vc = tmp_gt_vc;
-      tp = tmp_tp;
-      pty = tmp_pty;
-      ab = tmp_ab;
-      segment = tmp_segment;
-    } else {
-      // compare the values with the saved ones
-      if (tmp_pi != pi) {
-        std::cout << "Inconsistent PI value across blocks" << std::endl;
-        return 1;
-      }
-      if (tmp_gt_vc != gt_vc) {
-        std::cout
-            << "Inconsistent Group Type or Version Code value across blocks"
-            << std::endl;
-        return 1;
-      }
-      if (tmp_tp != tp) {
-        std::cout << "Inconsistent TP value across blocks" << std::endl;
-        return 1;
-      }
-      if (tmp_pty != pty) {
-        std::cout << "Inconsistent PTY value across blocks" << std::endl;
+int run_decoder(ArgumentParser &parser, MetricsExporter *exporter) {
+  if (parser.is_stream()) {
+    int fd = STDIN_FILENO;
+    if (!parser.get_stream_path().empty()) {
+      fd = open(parser.get_stream_path().c_str(), O_RDONLY);
+      if (fd < 0) {
+        std::cerr << "Cannot open " << parser.get_stream_path() << ": " << std::strerror(errno) << std::endl;
         return 1;
       }
     }
+    StationTable table;
+    std::unique_ptr<QualityMonitor> monitor;
+    if (parser.get_monitor_interval() || parser.get_alert_threshold() >= 0) {
+      monitor.reset(new QualityMonitor(parser.get_monitor_interval(), parser.get_alert_threshold(), std::cout, std::cerr));
+    }
+    StreamDecoder decoder(parser.get_format(), parser.get_max_bad_blocks(), parser.get_correct(), parser.is_stations() ? &table : nullptr,
+                          parser.get_sample_rate(), exporter, monitor.get());
+    int ret = decoder.run(fd);
+    if (fd != STDIN_FILENO) close(fd);
+    return ret;
   }
-  return 0;
-}
-
-void Group2A::print_info() {
-  std::cout << "PI: " << pi << std::endl;
-  std::cout << "GT: " << "2A" << std::endl;
-  std::cout << "TP: " << tp << std::endl;
-  std::cout << "PTY: " << (int)pty << std::endl;
-  std::cout << "A/B: " << ab << std::endl;
-  std::cout << "RT: \"" << trim_space_end(rt) << "\"" << std::endl;
-}
-
-int Group0A::parse() {
-  uint16_t tmp_pi{};
-  uint8_t tmp_gt_vc{};
-  bool tmp_tp{};
-  uint8_t tmp_pty{};
-  bool tmp_ta{};
-  bool tmp_ms{};
-  uint8_t tmp_di{};
-  uint8_t tmp_segment{};
-  uint32_t tmp_af1{};
-  uint32_t tmp_af2{};
-  uint8_t tmp_c1{};
-  uint8_t tmp_c2{};
-  uint32_t block{};
-
-  bool first_valid_group = true;
-
-  // iterate over 4 groups, some might be empty
-  for (int group = 0; group < 4; group++) {
-    // if the group is empty, do not process it
-    if (is_group_empty(mData, group)) continue;
 
-    // block 0
-    block = mData[static_cast<size_t>(group) * 4];
-    tmp_pi = (block & pi_mask) >> 10;
+  if (parser.get_blocks().empty()) {
+    std::cout << "No complete group found" << std::endl;
+    return 2;
+  }
 
-    // block 1
-    block = mData[static_cast<size_t>(group) * 4 + 1];
-    tmp_gt_vc = (block & gt_vc_mask) >> 21;
-    tmp_tp = (block & tp_mask) >> 20;
-    tmp_pty = (block & pty_mask) >> 15;
-    tmp_ta = (block & ta_mask) >> 14;
-    tmp_ms = (block & ms_mask) >> 13;
-    tmp_di = (block & di_mask) >> 12;
-    tmp_segment = (block & segment_mask_0A) >> 10;
+  if (parser.is_stations()) {
+    StationTable table;
+    int ret = parser.collect_stations(table);
+    if (ret != 0) return ret;
+    StageTimer timer(STAGE_DECODE);
+    print_stations(table);
+    return 0;
+  }
 
-    // block 2
-    block = mData[static_cast<size_t>(group) * 4 + 2];
-    tmp_af1 = (block & af1_mask) >> 18;
-    tmp_af2 = (block & af2_mask) >> 10;
+  rds_assembler assembler;
+  rds_assembler_init(&assembler);
+  StageTimer timer(STAGE_DECODE);
+  int sort_res = parser.sort_blocks(assembler);
+  if (sort_res != 0) return sort_res;
 
-    // block 3
-    block = mData[static_cast<size_t>(group) * 4 + 3];
-    tmp_c1 = (block & c1_mask) >> 18;
-    tmp_c2 = (block & c2_mask) >> 10;
-    // fill the characters into the string
-    ps[group * 2] = static_cast<char>(tmp_c1);
-    ps[group * 2 + 1] = static_cast<char>(tmp_c2);
+  // the group type is decided by the first group
+  if (assembler.group_type == GROUP_0A) {
+    Group0A group0A(assembler);
+    int ret = group0A.parse();
+    if (ret != 0) return ret;
+    
+    group0A.print_info();
 
-    // first group, save values
-    if (first_valid_group) {
-      first_valid_group = false;
-      pi = tmp_pi;
-      gt_vc = tmp_gt_vc;
-      tp = tmp_tp;
-      pty = tmp_pty;
-      ta = tmp_ta;
-      ms = tmp_ms;
-      di = tmp_di;
-      segment = tmp_segment;
-      af1 = tmp_af1;
-      af2 = tmp_af2;
-    } else {
-      // compare the values with the saved ones
-      if (tmp_pi != pi) {
-        std::cout << "Inconsistent PI value across blocks" << std::endl;
-        return 1;
-      }
-      if (tmp_gt_vc != gt_vc) {
-        std::cout << "Inconsistent Group Type or Version Code value across blocks"
-                  << std::endl;
-        return 1;
-      }
-      if (tmp_tp != tp) {
-        std::cout << "Inconsistent TP value across blocks" << std::endl;
-        return 1;
-      }
-      if (tmp_pty != pty) {
-        std::cout << "Inconsistent PTY value across blocks" << std::endl;
-        return 1;
-      }
-      if (tmp_ta != ta) {
-        std::cout << "Inconsistent TA value across blocks" << std::endl;
-        return 1;
-      }
-      if (tmp_ms != ms) {
-        std::cout << "Inconsistent MS value across blocks" << std::endl;
-        return 1;
-      }
-    }
+  } else if (assembler.group_type == GROUP_2A) {
+    Group2A group2A(assembler);
+    int ret = group2A.parse();
+    if (ret != 0) return ret;
+    group2A.print_info();
+  } else {
+    std::cout << rds_status_message(RDS_ERROR_UNSUPPORTED_GROUP) << std::endl;
+    return 1;
   }
   return 0;
 }
 
-void Group0A::print_info() {
-  std::cout << "PI: " << pi << std::endl;
-  std::cout << "GT: " << "0A" << std::endl;
-  std::cout << "TP: " << tp << std::endl;
-  std::cout << "PTY: " << (int)pty << std::endl;
-  std::cout << "TA: " << (ta ? "Active" : "Inactive") << std::endl;
-  std::cout << "MS: " << (ms ? "Music" : "Speech") << std::endl;
-  std::cout << "DI: " << (int)di << std::endl;
-  std::cout << "AF: " << format_frequency(af1) << ", " << format_frequency(af2)
-            << std::endl;
-  std::cout << "PS: \"" << trim_space_end(ps) << "\"" << std::endl;
-}
-
 int main(int argc, char *argv[]) {
   if (argc == 1) {
     std::cout << helpMessage;
@@ -391,28 +396,14 @@ int main(int argc, char *argv[]) {
     return 1;
   }
 
-  int sort_res = parser.sort_blocks();
-  if (sort_res != 0) return sort_res;
-
-  // check the group type from the first block
-  GroupType groupType = get_group(parser.get_blocks()[1]);
-  if (groupType == GROUP_0A) {
-    Group0A group0A(parser.get_blocks());
-    group0A.sort_0A_data();
-    int ret = group0A.parse();
-    if (ret != 0) return ret;
-    
-    group0A.print_info();
-
-  } else if (groupType == GROUP_2A) {
-    Group2A group2A(parser.get_blocks());
-    group2A.sort_2A_data();
-    int ret = group2A.parse();
-    if (ret != 0) return ret;
-    group2A.print_info();
-  } else {
-    std::cout << "Unsupported group type" << std::endl;
-    return 1;
+  std::unique_ptr<MetricsExporter> exporter;
+  if (!parser.get_metrics_path().empty()) {
+    exporter.reset(new MetricsExporter(parser.get_metrics_path(), parser.get_metrics_format(), parser.get_metrics_interval()));
   }
-  return 0;
+  int ret = run_decoder(parser, exporter.get());
+  if (exporter && !exporter->write()) {
+    std::cerr << "Cannot write metrics to " << parser.get_metrics_path() << std::endl;
+    if (ret == 0) ret = 1;
+  }
+  return ret;
 }
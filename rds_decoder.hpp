@@ -14,55 +14,23 @@
 #pragma once
 
 #include <algorithm>
+#include <cstring>
 #include <bitset>
 #include <cstdio>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "bitstream.hpp"
 #include "common.hpp"
-
-const char *helpMessage = R"(
-Usage: ./rds_encoder -b BINARY_STRING
-
-Description:
-  This program decodes RDS data from a binary string and display the information for Group 0A or 2A.
-)";
-
-// Constants for group type codes and masks
-const uint8_t group_type_mask = 0b11111;
-const uint32_t pi_mask = 67107840;
-const uint32_t gt_vc_mask = 65011712;
-const uint32_t tp_mask = 1048576;
-const uint32_t pty_mask = 1015808;
-const uint32_t ta_mask = 16384;
-const uint32_t ms_mask = 8192;
-const uint32_t di_mask = 4096;
-const uint32_t segment_mask_0A = 3072;
-const uint32_t segment_mask_2A = 15360;
-const uint32_t af1_mask = 66846720;
-const uint32_t af2_mask = 261120;
-const uint32_t c1_mask = 66846720;
-const uint32_t c2_mask = 261120;
-
-const uint32_t crc_mask = 1023;                       /**< Mask for CRC */
-const uint32_t inv_crc_mask = 67107840;               /**< Inverse CRC mask */
-
-/**
- * Determines the RDS group type from the first block of data.
- * @param block The 32-bit block value
- */
-GroupType get_group(uint32_t block);
-
-/**
- * Formats a frequency value into a human-readable string.
- * @param frequency The 32-bit frequency value.
- */
-std::string format_frequency(uint32_t frequency);
-
-/** Trims trailing spaces from a string. */
-std::string trim_space_end(std::string input);
+#include "rds.h"
+#include "rds_metrics.hpp"
+#include "rds_monitor.hpp"
+#include "rds_stations.hpp"
+#include "rds_stream.hpp"
+#include "rds_sync.hpp"
 
 /**
  * Parses command-line arguments and validates input.
@@ -80,110 +48,107 @@ private:
   std::vector<uint32_t> blocks;    /**< Parsed blocks of data */
   Error error;                     /**< Stores parsing errors */
   std::string binary_string_value; /**< Binary string input from arguments */
+  bool synchronize;                /**< Find block boundaries in the input */
+  unsigned max_bad_blocks;         /**< Flywheel limit for the synchronizer */
+  bool correct;                    /**< Repair burst errors in blocks */
+  bool stream;                     /**< Decode a stream instead of a string */
+  std::string stream_path;         /**< Stream source, standard input if empty */
+  BitFormat format;                /**< Format of the stream */
+  unsigned sample_rate;            /**< Samples per second of an f32 or IQ stream */
+  bool stations;                   /**< Summarize every station instead of one message */
+  std::string metrics_path;        /**< File for the decoder statistics, empty for none */
+  MetricFormat metrics_format;     /**< Format of the decoder statistics */
+  unsigned metrics_interval;       /**< Seconds between statistics writes in stream mode, 0 for none */
+  unsigned monitor_interval;       /**< Seconds of stream time between status lines, 0 for none */
+  double alert_threshold;          /**< Block error rate in percent that raises an alert, negative for none */
+
+  /**
+   * Sorts one group of blocks by their offset words. Uncorrectable blocks
+   * are reported when correction is enabled, blocks sharing an offset word
+   * always.
+   * @param index Index of the group in the input.
+   * @param sorted The group in A, B, C, D order.
+   * @return 0 if the group is usable, 1 if it should be skipped, 2 if the
+   *         whole input fails
+   */
+  int sort_group(size_t index, uint32_t *sorted);
+
+  /** Splits an aligned binary string of whole groups into blocks. */
+  void parse_aligned();
+
+  /** Feeds the binary string through the synchronizer and keeps complete groups. */
+  void parse_synchronized();
 
 public:
   /** Constructor that parses command-line arguments. */
   ArgumentParser(int argc, char *argv[]);
 
-  int sort_blocks();
+  /**
+   * Places blocks of each group by their offset word and collects the groups
+   * by segment address. Without correction the first block that matches no
+   * offset fails the whole input; with it, bad blocks are repaired where
+   * possible and groups that cannot be repaired are reported and skipped.
+   * @param assembler Collects the sorted groups, the type of the first group
+   *        decides the message type.
+   * @return 0 on success, 2 if no usable group remains
+   */
+  int sort_blocks(rds_assembler &assembler);
 
-  /** Returns the error status of the parser. */
-  Error get_error() { return error; }
+  /**
+   * Sorts the blocks of each group like sort_blocks() and sends every group
+   * to the station that sent it.
+   * @param table The stations.
+   * @return 0 on success, 2 if no usable group remains
+   */
+  int collect_stations(StationTable &table);
 
-  /** Returns the parsed blocks of data. */
-  std::vector<uint32_t> get_blocks() { return blocks; }
-};
+  /** Returns true if the input should be decoded as a stream. */
+  bool is_stream() { return stream; }
 
-/**
- * Represents common fields shared across different RDS groups.
- */
-class CommonGroup {
-public:
-  /** Constructor that initializes the group with data blocks. */
-  CommonGroup(std::vector<uint32_t> data) : mData(data) {}
-
-  /** Virtual function to print group-specific information. */
-  virtual void print_info() = 0;
-
-  std::vector<uint32_t> mData; // Data blocks for the group
-protected:
-  uint8_t gt_vc; /**< Group Type Code + Version Code */
-  uint16_t pi;   /**< Program Identification code */
-  bool tp;       /**< Traffic Program flag */
-  uint8_t pty;   /**< Program Type code */
-};
+  /** Returns the path of the stream, empty for standard input. */
+  const std::string &get_stream_path() { return stream_path; }
 
-/**
- * Handles parsing and displaying information for Group 2A (Radio Text).
- */
-class Group2A : public CommonGroup {
-private:
-  std::string rt;  /**< Radio text (up to 64 characters) */
-  bool ab;         /**< Radio text A/B flag */
-  uint8_t segment; /**< Segment address code */
+  /** Returns the format of the stream. */
+  BitFormat get_format() { return format; }
 
-public:
-  /** Constructor initializing with data blocks. */
-  Group2A(std::vector<uint32_t> data) : CommonGroup(data), rt(64, '_') {}
+  /** Returns the sample rate of an f32 stream. */
+  unsigned get_sample_rate() { return sample_rate; }
 
-  /**
-   * Sorts groups into a new vector with empty places for absent ones
-   * @param data Vector containing all received data
-   * @returns sorted data of 16 groups (4 blocks each)
-   */
-  void sort_2A_data(); 
+  /** Returns the flywheel limit for the synchronizer. */
+  unsigned get_max_bad_blocks() { return max_bad_blocks; }
 
-  /** Prints information specific to Group 2A. */
-  void print_info() override;
+  /** Returns true if every station should be summarized. */
+  bool is_stations() { return stations; }
 
-  /** Parses the data blocks for Group 2A. */
-  int parse();
-};
+  /** Returns the file for the decoder statistics, empty for none. */
+  const std::string &get_metrics_path() { return metrics_path; }
 
-/**
- * Handles parsing and displaying information for Group 0A.
- */
-class Group0A : public CommonGroup {
-private:
-  bool ta;         /**< Traffic Announcement flag */
-  bool ms;         /**< Music/Speech indicator */
-  uint8_t di;      /**< Decoder Information control code */
-  uint8_t segment; /**< Segment address code */
-  uint32_t af1;    /**< Alternative Frequency #1 */
-  uint32_t af2;    /**< Alternative Frequency #2 */
-  std::string ps;  /**< Program Service name (up to 8 characters) */
+  /** Returns the format of the decoder statistics. */
+  MetricFormat get_metrics_format() { return metrics_format; }
 
-public:
-  /** Constructor initializing with data blocks. */
-  Group0A(std::vector<uint32_t> data) : CommonGroup(data), ps(8, '_') {}
+  /** Returns the seconds between statistics writes in stream mode, 0 for none. */
+  unsigned get_metrics_interval() { return metrics_interval; }
 
-  /**
-   * Sorts groups into a new vector with empty places for absent ones
-   * @param data Vector containing all received data
-   * @returns sorted data of 4 groups (4 blocks each)
-   */
-  void sort_0A_data();
+  /** Returns the seconds of stream time between status lines, 0 for none. */
+  unsigned get_monitor_interval() { return monitor_interval; }
 
-  /**
-   * @brief Prints the information contained in the Group0A object.
-   * 
-   * This function outputs various fields of the Group0A object to the standard output,
-   * including Program Identification (PI), Group Type (GT), Traffic Program (TP), 
-   * Program Type (PTY), Traffic Announcement (TA), Music/Speech (MS), Decoder Information (DI),
-   * Alternative Frequencies (AF), and Program Service name (PS).
-   */
-  void print_info() override;
+  /** Returns the block error rate in percent that raises an alert, negative for none. */
+  double get_alert_threshold() { return alert_threshold; }
 
-  /**
- * @brief Parses the RDS Group 0A data from the provided mData array.
- *
- * This function iterates over 4 groups of RDS data, extracting various fields
- * such as PI, Group Type, TP, PTY, TA, MS, DI, segment, AF1, and AF2 from each
- * group. It checks for consistency of these values across the groups and fills
- * the PS (Program Service) string with characters extracted from the blocks.
- *
- * @return int Returns 0 if all groups are consistent, otherwise returns 1 if
- *         any inconsistency is found.
- */
-  int parse();
+  /** Returns true if burst errors should be repaired. */
+  bool get_correct() { return correct; }
+
+  /** Returns the error status of the parser. */
+  Error get_error() { return error; }
+
+  /** Returns the parsed blocks of data. */
+  const std::vector<uint32_t> &get_blocks() const { return blocks; }
 };
+
+/**
+ * Decodes the input selected by the command line and prints the result.
+ * @param parser The parsed command line.
+ * @param exporter Writes the statistics periodically in stream mode, if set.
+ * @return 0 on success, 1 on invalid input, 2 if nothing could be decoded
+ */
+int run_decoder(ArgumentParser &parser, MetricsExporter *exporter);
@@ -0,0 +1,407 @@
+/**
+ * @file       rds_demodulator.cpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Recovery of the RDS bitstream from the FM multiplex signal
+ *
+ * @date      17 October  2026 \n
+ */
+
+#include "rds_demodulator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "common.hpp"
+#include "rds_modulator.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RDS_X86 1
+#endif
+
+const double pi = 3.14159265358979323846;
+
+const double filtered_rate = 16 * bit_rate;  /**< Lowest rate after decimation, 16 samples per bit */
+const double bandpass_cutoff = 3000;         /**< Half the bandwidth of the bandpass in Hz */
+const double bandpass_transition = 1500;     /**< Width of the bandpass edges in Hz */
+const double carrier_bandwidth = 20;         /**< Noise bandwidth of the Costas loop in Hz */
+const double timing_gain = 0.02;             /**< Bit periods the early-late gate moves per unit of error */
+const double mpx_rate_target = 240000;      /**< Lowest multiplex rate after decimation of IQ samples */
+const double channel_cutoff = 0.45;         /**< Channel filter cutoff as a fraction of the multiplex rate */
+const double channel_transition = 0.1;      /**< Width of the channel filter edge as a fraction of the multiplex rate */
+const double period_tolerance = 0.005;       /**< Largest deviation of the bit rate from the standard */
+const float level_gain = 0.02f;              /**< Weight of a bit in the averages of the timing recovery */
+const float boundary_ratio = 1.25f;          /**< Power at the bit boundaries over the centers that moves the timing */
+
+/**
+ * Reads a little-endian integer.
+ * @param data Input, bytes bytes.
+ * @param bytes Number of bytes.
+ */
+static uint32_t get_le(const char *data, unsigned bytes) {
+  uint32_t value = 0;
+  for (unsigned i = bytes; i-- > 0;) value = (value << 8) | static_cast<uint8_t>(data[i]);
+  return value;
+}
+
+long parse_wav_header(const char *data, size_t length, WavFormat &format) {
+  if (length < 12) return 0;
+  if (std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0) return -1;
+  bool has_format = false;
+  size_t offset = 12;
+  for (;;) {
+    if (length < offset + 8) return 0;
+    const char *chunk = data + offset;
+    uint32_t size = get_le(chunk + 4, 4);
+    if (std::memcmp(chunk, "data", 4) == 0) {
+      if (!has_format) return -1;
+      format.data_bytes = size;
+      return static_cast<long>(offset + 8);
+    }
+    if (std::memcmp(chunk, "fmt ", 4) == 0) {
+      if (size < 16) return -1;
+      if (length < offset + 8 + size) return 0;
+      uint32_t tag = get_le(chunk + 8, 2);
+      // WAVE_FORMAT_EXTENSIBLE names the real format at the start of its GUID
+      if (tag == 0xFFFE && size >= 40) tag = get_le(chunk + 32, 2);
+      format.channels = get_le(chunk + 10, 2);
+      format.sample_rate = get_le(chunk + 12, 4);
+      format.bits = get_le(chunk + 22, 2);
+      format.is_float = tag == 3;
+      if (format.channels == 0 || !((tag == 1 && format.bits == 16) || (tag == 3 && format.bits == 32))) return -1;
+      has_format = true;
+    }
+    // chunks are padded to an even size
+    offset += 8 + size + (size & 1);
+  }
+}
+
+float dot_product_scalar(const float *samples, const float *taps, size_t count) {
+  float sum = 0;
+  for (size_t i = 0; i < count; i++) sum += samples[i] * taps[i];
+  return sum;
+}
+
+#ifdef RDS_X86
+static float dot_product_sse(const float *samples, const float *taps, size_t count) {
+  __m128 sum0 = _mm_setzero_ps();
+  __m128 sum1 = _mm_setzero_ps();
+  for (size_t i = 0; i < count; i += 8) {
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_loadu_ps(taps + i)));
+    sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(samples + i + 4), _mm_loadu_ps(taps + i + 4)));
+  }
+  __m128 sum = _mm_add_ps(sum0, sum1);
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum);
+}
+
+__attribute__((target("avx2,fma"))) static float dot_product_avx2(const float *samples, const float *taps, size_t count) {
+  // two accumulators hide the latency of the fused multiply-add
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+  for (size_t i = 0; i < count; i += 16) {
+    sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(samples + i), _mm256_loadu_ps(taps + i), sum0);
+    sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(samples + i + 8), _mm256_loadu_ps(taps + i + 8), sum1);
+  }
+  __m256 sum8 = _mm256_add_ps(sum0, sum1);
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(sum8), _mm256_extractf128_ps(sum8, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum);
+}
+#endif
+
+/**
+ * Picks the widest dot product the CPU supports.
+ * @return The dot product function.
+ */
+static float (*select_dot_product())(const float *, const float *, size_t) {
+#ifdef RDS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return dot_product_avx2;
+  return dot_product_sse;
+#else
+  return dot_product_scalar;
+#endif
+}
+
+static float (*const dot_product_impl)(const float *, const float *, size_t) = select_dot_product();
+
+float dot_product(const float *samples, const float *taps, size_t count) { return dot_product_impl(samples, taps, count); }
+
+/**
+ * Rounds a number of filter taps up to what dot_product() accepts.
+ * @param count Number of taps.
+ */
+static size_t pad_taps(size_t count) { return (count + 15) / 16 * 16; }
+
+void convert_iq(const char *data, size_t count, BitFormat format, float *in_phase, float *quadrature) {
+  if (format == FORMAT_CU8) {
+    const uint8_t *in = reinterpret_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < count; i++) {
+      in_phase[i] = (in[2 * i] - 127.5f) / 127.5f;
+      quadrature[i] = (in[2 * i + 1] - 127.5f) / 127.5f;
+    }
+  } else if (format == FORMAT_CS16) {
+    for (size_t i = 0; i < count; i++) {
+      int16_t pair[2];
+      std::memcpy(pair, data + i * sizeof(pair), sizeof(pair));
+      in_phase[i] = pair[0] / 32768.0f;
+      quadrature[i] = pair[1] / 32768.0f;
+    }
+  } else {
+    for (size_t i = 0; i < count; i++) {
+      float pair[2];
+      std::memcpy(pair, data + i * sizeof(pair), sizeof(pair));
+      in_phase[i] = pair[0];
+      quadrature[i] = pair[1];
+    }
+  }
+}
+
+/**
+ * The discriminator loop, inlined into a version for each instruction set.
+ * @param in_phase count + 1 I components.
+ * @param quadrature count + 1 Q components.
+ * @param count Number of outputs.
+ * @param scale Factor applied to the phase differences.
+ * @param output Output, count values.
+ */
+static inline __attribute__((always_inline)) void discriminate_loop(const float *in_phase, const float *quadrature, size_t count, float scale,
+                                                                    float *output) {
+  for (size_t n = 0; n < count; n++) {
+    // z[n] * conj(z[n - 1])
+    float x = in_phase[n + 1] * in_phase[n] + quadrature[n + 1] * quadrature[n];
+    float y = quadrature[n + 1] * in_phase[n] - in_phase[n + 1] * quadrature[n];
+    float ax = std::fabs(x);
+    float ay = std::fabs(y);
+    // selections by multiplying with 0 or 1, comparisons that pick a value
+    // keep the loop from vectorizing as they might trap
+    float swap = static_cast<float>(ay > ax);
+    float high = ax + swap * (ay - ax);
+    float low = ay + swap * (ax - ay);
+    // atan of the ratio in [0, 1], then mirrored into the right octant
+    float a = low / (high + 1e-30f);
+    float a2 = a * a;
+    float angle = ((-0.0464964749f * a2 + 0.15931422f) * a2 - 0.327622764f) * a2 * a + a;
+    angle += swap * (1.57079637f - 2 * angle);
+    angle += static_cast<float>(x < 0) * (3.14159274f - 2 * angle);
+    output[n] = std::copysign(angle, y) * scale;
+  }
+}
+
+static void discriminate_default(const float *in_phase, const float *quadrature, size_t count, float scale, float *output) {
+  discriminate_loop(in_phase, quadrature, count, scale, output);
+}
+
+#ifdef RDS_X86
+__attribute__((target("avx2,fma"))) static void discriminate_avx2(const float *in_phase, const float *quadrature, size_t count, float scale,
+                                                                   float *output) {
+  discriminate_loop(in_phase, quadrature, count, scale, output);
+}
+#endif
+
+/**
+ * Picks the widest discriminator the CPU supports.
+ * @return The discriminator function.
+ */
+static void (*select_discriminate())(const float *, const float *, size_t, float, float *) {
+#ifdef RDS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return discriminate_avx2;
+#endif
+  return discriminate_default;
+}
+
+static void (*const discriminate_impl)(const float *, const float *, size_t, float, float *) = select_discriminate();
+
+void discriminate(const float *in_phase, const float *quadrature, size_t count, float scale, float *output) {
+  discriminate_impl(in_phase, quadrature, count, scale, output);
+}
+
+FmDemodulator::FmDemodulator(unsigned sample_rate)
+    : decimation(std::max(1u, static_cast<unsigned>(sample_rate / mpx_rate_target))), mpx_rate(0), filter_length(0), taps(), input_i(),
+      input_q(), input_next(0), channel_i(1, 0.0f), channel_q(1, 0.0f), output() {
+  double rate = static_cast<double>(sample_rate) / decimation;
+  mpx_rate = static_cast<unsigned>(std::lround(rate));
+
+  // windowed sinc lowpass, Hamming window
+  size_t length = static_cast<size_t>(std::ceil(3.3 / channel_transition * decimation)) | 1;
+  filter_length = pad_taps(length);
+  taps.assign(filter_length, 0.0f);
+  double cutoff = channel_cutoff / decimation;
+  std::vector<double> lowpass(length);
+  double gain = 0;
+  for (size_t k = 0; k < length; k++) {
+    double t = static_cast<double>(k) - static_cast<double>(length - 1) / 2;
+    double sinc = t == 0 ? 2 * cutoff : std::sin(2 * pi * cutoff * t) / (pi * t);
+    lowpass[k] = sinc * (0.54 - 0.46 * std::cos(2 * pi * static_cast<double>(k) / static_cast<double>(length - 1)));
+    gain += lowpass[k];
+  }
+  for (size_t k = 0; k < length; k++) taps[filter_length - length + k] = static_cast<float>(lowpass[k] / gain);
+  input_i.assign(filter_length - 1, 0.0f);
+  input_q.assign(filter_length - 1, 0.0f);
+  input_next = filter_length - 1;
+}
+
+size_t FmDemodulator::demodulate(const float *in_phase, const float *quadrature, size_t count) {
+  input_i.insert(input_i.end(), in_phase, in_phase + count);
+  input_q.insert(input_q.end(), quadrature, quadrature + count);
+  for (; input_next < input_i.size(); input_next += decimation) {
+    size_t start = input_next + 1 - filter_length;
+    channel_i.push_back(dot_product(input_i.data() + start, taps.data(), filter_length));
+    channel_q.push_back(dot_product(input_q.data() + start, taps.data(), filter_length));
+  }
+  size_t consumed = std::min(input_next + 1 - filter_length, input_i.size());
+  input_i.erase(input_i.begin(), input_i.begin() + static_cast<std::ptrdiff_t>(consumed));
+  input_q.erase(input_q.begin(), input_q.begin() + static_cast<std::ptrdiff_t>(consumed));
+  input_next -= consumed;
+
+  // a phase difference of pi is half the multiplex rate
+  size_t samples = channel_i.size() - 1;
+  output.resize(samples);
+  discriminate(channel_i.data(), channel_q.data(), samples, static_cast<float>(mpx_rate / (2 * pi * fm_deviation)), output.data());
+  channel_i.erase(channel_i.begin(), channel_i.begin() + static_cast<std::ptrdiff_t>(samples));
+  channel_q.erase(channel_q.begin(), channel_q.begin() + static_cast<std::ptrdiff_t>(samples));
+  return samples;
+}
+
+Demodulator::Demodulator(unsigned sample_rate)
+    : sample_rate(sample_rate), decimation(std::max(1u, static_cast<unsigned>(sample_rate / filtered_rate))), filter_length(0), taps_i(),
+      taps_q(), input(), input_next(0), carrier_phase(0), carrier_step(0), carrier_gain(0), frequency_gain(0), power(0), match_length(0),
+      match_taps(), baseband(), matched(), symbol_period(0), nominal_period(0), symbol_time(0), level(0), boundary_level(0), previous(0), output() {
+  double rate = static_cast<double>(sample_rate) / decimation;
+
+  // windowed sinc lowpass shifted to the subcarrier, Hamming window
+  size_t length = static_cast<size_t>(std::ceil(3.3 * sample_rate / bandpass_transition)) | 1;
+  filter_length = pad_taps(length);
+  taps_i.assign(filter_length, 0.0f);
+  taps_q.assign(filter_length, 0.0f);
+  double omega = 2 * pi * subcarrier / sample_rate;
+  double cutoff = bandpass_cutoff / sample_rate;
+  double gain = 0;
+  std::vector<double> lowpass(length);
+  for (size_t k = 0; k < length; k++) {
+    double t = static_cast<double>(k) - static_cast<double>(length - 1) / 2;
+    double sinc = t == 0 ? 2 * cutoff : std::sin(2 * pi * cutoff * t) / (pi * t);
+    lowpass[k] = sinc * (0.54 - 0.46 * std::cos(2 * pi * static_cast<double>(k) / static_cast<double>(length - 1)));
+    gain += lowpass[k];
+  }
+  // tap k weighs the sample k samples back, the padding goes before the oldest
+  for (size_t k = 0; k < length; k++) {
+    size_t j = filter_length - 1 - k;
+    taps_i[j] = static_cast<float>(lowpass[k] / gain * std::cos(omega * static_cast<double>(k)));
+    taps_q[j] = static_cast<float>(lowpass[k] / gain * std::sin(omega * static_cast<double>(k)));
+  }
+  input.assign(filter_length - 1, 0.0f);
+  input_next = filter_length - 1;
+
+  // the carrier turns by its alias at the filtered rate, the loop starts there
+  carrier_step = std::remainder(omega * decimation, 2 * pi);
+  double zeta = std::sqrt(0.5);
+  double theta = carrier_bandwidth / rate / (zeta + 1 / (4 * zeta));
+  double denominator = 1 + 2 * zeta * theta + theta * theta;
+  carrier_gain = 4 * zeta * theta / denominator;
+  frequency_gain = 4 * theta * theta / denominator;
+
+  // the time-reversed symbol, a bit period on each side of its center
+  nominal_period = rate / bit_rate;
+  symbol_period = nominal_period;
+  size_t radius = static_cast<size_t>(std::ceil(nominal_period));
+  match_length = pad_taps(2 * radius + 1);
+  match_taps.assign(match_length, 0.0f);
+  double energy = 0;
+  for (size_t j = 0; j <= 2 * radius; j++) energy += std::pow(biphase_symbol((static_cast<double>(j) - radius) / rate), 2);
+  for (size_t j = 0; j <= 2 * radius; j++) {
+    double symbol = biphase_symbol((static_cast<double>(j) - radius) / rate) / std::sqrt(energy);
+    match_taps[match_length - 1 - 2 * radius + j] = static_cast<float>(symbol);
+  }
+  baseband.assign(match_length - 1, 0.0f);
+  symbol_time = nominal_period / 2 + 1;
+}
+
+void Demodulator::filter() {
+  const float *window = input.data() + input_next + 1 - filter_length;
+  for (; input_next < input.size(); input_next += decimation, window += decimation) {
+    float in_phase = dot_product(window, taps_i.data(), filter_length);
+    float quadrature = dot_product(window, taps_q.data(), filter_length);
+
+    // Costas loop, the product of both arms is the phase error of BPSK
+    float c = static_cast<float>(std::cos(carrier_phase));
+    float s = static_cast<float>(std::sin(carrier_phase));
+    float real = in_phase * c + quadrature * s;
+    float imag = quadrature * c - in_phase * s;
+    float sample_power = real * real + imag * imag;
+    power = power == 0 ? sample_power : power + (sample_power - power) * 0.002f;
+    double error = power > 0 ? std::max(-1.0f, std::min(1.0f, real * imag / power)) : 0;
+    carrier_step += frequency_gain * error;
+    carrier_phase = std::remainder(carrier_phase + carrier_step + carrier_gain * error, 2 * pi);
+    baseband.push_back(real);
+  }
+
+  // keep what the next output still needs
+  size_t consumed = std::min(input_next + 1 - filter_length, input.size());
+  input.erase(input.begin(), input.begin() + static_cast<std::ptrdiff_t>(consumed));
+  input_next -= consumed;
+}
+
+void Demodulator::match() {
+  size_t count = baseband.size() + 1 - match_length;
+  for (size_t i = 0; i < count; i++) matched.push_back(dot_product(baseband.data() + i, match_taps.data(), match_length));
+  baseband.erase(baseband.begin(), baseband.begin() + static_cast<std::ptrdiff_t>(count));
+}
+
+float Demodulator::interpolate(double time) const {
+  size_t index = static_cast<size_t>(time);
+  float fraction = static_cast<float>(time - static_cast<double>(index));
+  return matched[index] + fraction * (matched[index + 1] - matched[index]);
+}
+
+void Demodulator::recover_bits() {
+  double quarter = nominal_period / 4;
+  while (symbol_time + quarter + 1 < static_cast<double>(matched.size())) {
+    float early = interpolate(symbol_time - quarter);
+    float center = interpolate(symbol_time);
+    float late = interpolate(symbol_time + quarter);
+    float boundary = interpolate(symbol_time - 2 * quarter);
+    if (level == 0) level = center * center;
+    level += (center * center - level) * level_gain;
+    boundary_level += (boundary * boundary - boundary_level) * level_gain;
+
+    // a center sampled early sees the late side closer to the peak
+    double error = level > 0 ? std::max(-1.0f, std::min(1.0f, center * (late - early) / level)) : 0;
+    symbol_period += timing_gain * 0.01 * nominal_period * error;
+    symbol_period = std::max(nominal_period * (1 - period_tolerance), std::min(nominal_period * (1 + period_tolerance), symbol_period));
+
+    unsigned symbol = center > 0;
+    output.push_back(static_cast<uint8_t>(symbol ^ previous));
+    previous = symbol;
+
+    symbol_time += symbol_period + timing_gain * nominal_period * error;
+    if (boundary_level > level * boundary_ratio) {
+      // locked to the boundaries, which look like centers of inverted symbols
+      symbol_time -= 2 * quarter;
+      std::swap(level, boundary_level);
+    }
+  }
+
+  size_t consumed = std::min(static_cast<size_t>(std::max(0.0, symbol_time - 2 * quarter - 1)), matched.size());
+  matched.erase(matched.begin(), matched.begin() + static_cast<std::ptrdiff_t>(consumed));
+  symbol_time -= static_cast<double>(consumed);
+}
+
+size_t Demodulator::demodulate(const float *samples, size_t count) {
+  output.clear();
+  input.insert(input.end(), samples, samples + count);
+  filter();
+  match();
+  recover_bits();
+  return output.size();
+}
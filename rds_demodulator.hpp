@@ -0,0 +1,221 @@
+/**
+ * @file       rds_demodulator.hpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Recovery of the RDS bitstream from the FM multiplex signal
+ *
+ * @date      17 October  2026 \n
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bitstream.hpp"
+
+/* Sample layout of a WAV file */
+struct WavFormat {
+  unsigned sample_rate; /**< Samples per second */
+  unsigned channels;    /**< Interleaved channels, the first one is used */
+  unsigned bits;        /**< Bits per sample, 16 for integer and 32 for float */
+  bool is_float;        /**< IEEE float samples instead of integer PCM */
+  uint32_t data_bytes;  /**< Bytes of samples, 0xFFFFFFFF if unknown (streaming) */
+};
+
+/**
+ * Parses the header of a WAV file up to the first sample. Mono or
+ * multichannel 16-bit integer and 32-bit float PCM are supported.
+ * @param data The start of the file.
+ * @param length Number of bytes available.
+ * @param format Where the sample layout is stored.
+ * @return Size of the header in bytes, 0 if more bytes are needed, -1 if
+ *         the file is not a supported WAV file.
+ */
+long parse_wav_header(const char *data, size_t length, WavFormat &format);
+
+/**
+ * Dot product of samples and filter taps, the inner loop of every FIR
+ * filter of the demodulator. Uses AVX2 with FMA or SSE when the CPU
+ * supports it, selected at runtime.
+ * @param samples The samples.
+ * @param taps The taps.
+ * @param count Number of taps, a multiple of 16.
+ * @return The sum of the products.
+ */
+float dot_product(const float *samples, const float *taps, size_t count);
+
+/**
+ * Portable version of dot_product(), the fallback on other CPUs.
+ * @param samples The samples.
+ * @param taps The taps.
+ * @param count Number of taps.
+ * @return The sum of the products.
+ */
+float dot_product_scalar(const float *samples, const float *taps, size_t count);
+
+/**
+ * Converts IQ samples to floats with a full scale of 1 and separates the
+ * components. The loop is plain enough for the compiler to vectorize.
+ * @param data The samples, I and Q interleaved.
+ * @param count Number of I/Q pairs.
+ * @param format FORMAT_CU8, FORMAT_CS16 or FORMAT_CF32.
+ * @param in_phase Output, count I components.
+ * @param quadrature Output, count Q components.
+ */
+void convert_iq(const char *data, size_t count, BitFormat format, float *in_phase, float *quadrature);
+
+/**
+ * Phase differences of consecutive complex samples, the polar FM
+ * discriminator. The angle of z[n] * conj(z[n - 1]) comes from a
+ * polynomial approximation of atan2 (error below 1e-5 rad) built from
+ * comparisons, a division and multiply-adds, so the whole loop vectorizes;
+ * it runs on AVX2 when the CPU supports it, selected at runtime.
+ * @param in_phase count + 1 I components, the first belongs to the
+ *        sample before the first output.
+ * @param quadrature count + 1 Q components.
+ * @param count Number of outputs.
+ * @param scale Factor applied to the phase differences in radians.
+ * @param output Output, count values.
+ */
+void discriminate(const float *in_phase, const float *quadrature, size_t count, float scale, float *output);
+
+/**
+ * Turns the complex baseband of an FM receiver tuned to a station into the
+ * multiplex signal. A lowpass channel filter, of which only every
+ * decimation-th output is computed, keeps the station and brings the rate
+ * down to 240 to 480 kHz (or leaves a lower rate as it is), and the polar
+ * discriminator recovers the frequency deviation. A full-scale output is
+ * the fm_deviation of the standard.
+ */
+class FmDemodulator {
+public:
+  /**
+   * Constructor for FmDemodulator.
+   * @param sample_rate IQ samples per second, min_sample_rate to max_sample_rate.
+   */
+  explicit FmDemodulator(unsigned sample_rate);
+
+  /**
+   * Demodulates the next samples.
+   * @param in_phase The I components.
+   * @param quadrature The Q components.
+   * @param count Number of samples.
+   * @return Number of multiplex samples, available through mpx().
+   */
+  size_t demodulate(const float *in_phase, const float *quadrature, size_t count);
+
+  /** Returns the multiplex samples of the last call to demodulate(). */
+  const float *mpx() const { return output.data(); }
+
+  /** Returns the sample rate of the multiplex signal, rounded to whole samples per second. */
+  unsigned get_mpx_rate() const { return mpx_rate; }
+
+private:
+  unsigned decimation;             /**< IQ samples per multiplex sample */
+  unsigned mpx_rate;               /**< Multiplex samples per second */
+  size_t filter_length;            /**< Taps of the channel filter */
+  std::vector<float> taps;         /**< Channel filter taps, oldest sample first */
+  std::vector<float> input_i;      /**< I components still needed by the channel filter */
+  std::vector<float> input_q;      /**< Q components still needed by the channel filter */
+  size_t input_next;               /**< Index into the inputs of the newest sample of the next output */
+  std::vector<float> channel_i;    /**< Filtered I, the last one of the previous call first */
+  std::vector<float> channel_q;    /**< Filtered Q, the last one of the previous call first */
+  std::vector<float> output;       /**< Multiplex samples */
+};
+
+/**
+ * Recovers RDS bits from the FM multiplex signal, the inverse of the
+ * Modulator chain:
+ *
+ * - a complex 57 kHz bandpass filter, of which only every decimation-th
+ *   output is computed (the polyphase form of a decimator), brings the
+ *   subcarrier down to about 16 samples per bit;
+ * - a Costas loop locks to the suppressed carrier and leaves the real
+ *   biphase signal, with a sign ambiguity of the carrier phase;
+ * - a filter matched to the shaped biphase symbol and an early-late gate
+ *   on its output find the center of each bit, between samples. The
+ *   boundary between two equal symbols looks like the center of an
+ *   inverted one, so the timing moves by half a bit when the boundaries
+ *   carry clearly more power than the centers;
+ * - the sign at the center is the differentially encoded bit, comparing
+ *   it with the previous one removes the sign ambiguity.
+ *
+ * The carrier recovery does not need the 19 kHz pilot, which is missing
+ * from a bare subcarrier. Samples are processed in place as they arrive,
+ * so the bits of a signal of any length come out with a delay of a few
+ * bit periods.
+ */
+class Demodulator {
+public:
+  /**
+   * Constructor for Demodulator.
+   * @param sample_rate Samples per second, min_sample_rate to max_sample_rate.
+   */
+  explicit Demodulator(unsigned sample_rate);
+
+  /**
+   * Demodulates the next samples of the signal.
+   * @param samples The samples, full scale is 1.
+   * @param count Number of samples.
+   * @return Number of bits recovered, available through bits().
+   */
+  size_t demodulate(const float *samples, size_t count);
+
+  /** Returns the bits, 0 or 1, recovered by the last call to demodulate(). */
+  const uint8_t *bits() const { return output.data(); }
+
+  /** Returns the sample rate. */
+  unsigned get_sample_rate() const { return sample_rate; }
+
+  /** Returns the number of input samples per filtered sample. */
+  unsigned get_decimation() const { return decimation; }
+
+private:
+  /** Filters and decimates the buffered input into the Costas loop. */
+  void filter();
+
+  /** Runs the matched filter over the recovered baseband. */
+  void match();
+
+  /** Samples the matched filter output at the center of each bit. */
+  void recover_bits();
+
+  /**
+   * Returns the matched filter output between two samples.
+   * @param time Index into matched, with a fraction.
+   */
+  float interpolate(double time) const;
+
+  unsigned sample_rate;          /**< Samples per second */
+  unsigned decimation;           /**< Input samples per filtered sample */
+  size_t filter_length;          /**< Taps of the bandpass filter */
+  std::vector<float> taps_i;     /**< Bandpass taps, in-phase, oldest sample first */
+  std::vector<float> taps_q;     /**< Bandpass taps, quadrature, oldest sample first */
+  std::vector<float> input;      /**< Input samples still needed by the bandpass */
+  size_t input_next;             /**< Index into input of the newest sample of the next output */
+
+  double carrier_phase;          /**< Phase of the Costas loop oscillator in radians */
+  double carrier_step;           /**< Oscillator step per filtered sample in radians */
+  double carrier_gain;           /**< Proportional gain of the Costas loop */
+  double frequency_gain;         /**< Integral gain of the Costas loop */
+  float power;                   /**< Average power of the filtered signal */
+
+  size_t match_length;           /**< Taps of the matched filter */
+  std::vector<float> match_taps; /**< Matched filter taps, oldest sample first */
+  std::vector<float> baseband;   /**< Carrier-free samples still needed by the matched filter */
+  std::vector<float> matched;    /**< Matched filter output not yet sampled */
+
+  double symbol_period;          /**< Filtered samples per bit, tracked */
+  double nominal_period;         /**< Filtered samples per bit of the standard */
+  double symbol_time;            /**< Index into matched of the next bit center */
+  float level;                   /**< Average power at the bit centers */
+  float boundary_level;          /**< Average power half a bit from the centers */
+  unsigned previous;             /**< Sign of the last bit center */
+  std::vector<uint8_t> output;   /**< Recovered bits */
+};
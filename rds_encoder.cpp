@@ -13,77 +13,176 @@
 
 #include "rds_encoder.hpp"
 
-void Group2A::print_bits() {
-  uint32_t line{};
-  for (size_t b = 0; b < 16; b++) {
-    line = 0;
-    line |= static_cast<uint32_t>(pi) << 10;
-    line |= crc(line, offset_A);
-    print_26_bits(line);
-
-    line = 0;
-    line |= static_cast<uint32_t>(gt_vc) << 21;
-    line |= static_cast<uint32_t>(tp) << 20;
-    line |= static_cast<uint32_t>(pty) << 15;
-    line |= static_cast<uint32_t>(ab) << 14;
-    line |= static_cast<uint32_t>(b) << 10;
-    line |= crc(line, offset_B);
-    print_26_bits(line);
-
-    line = 0;
-    // radio text segment
-    uint8_t c0 = static_cast<uint8_t>(rt[(b * 4)]);
-    uint8_t c1 = static_cast<uint8_t>(rt[(b * 4) + 1]);
-    line |= static_cast<uint32_t>(c0) << 18;
-    line |= static_cast<uint32_t>(c1) << 10;
-    line |= crc(line, offset_C);
-    print_26_bits(line);
-
-    line = 0;
-    // radio text segment
-    uint8_t c2 = static_cast<uint8_t>(rt[(b * 4) + 2]);
-    uint8_t c3 = static_cast<uint8_t>(rt[(b * 4) + 3]);
-    line |= static_cast<uint32_t>(c2) << 18;
-    line |= static_cast<uint32_t>(c3) << 10;
-    line |= crc(line, offset_D);
-    print_26_bits(line);
+const char *helpMessage = R"(
+Usage: rds_encoder -g [GROUP] [FLAGS...] [--format ascii|packed|wav|f32|cu8|cs16|cf32] [--rate N]
+       rds_encoder --batch [FILE] [--format ascii]
+       rds_encoder --carousel [FILE] [OPTIONS...] [--format ascii|packed|wav|f32|cu8|cs16|cf32] [--rate N]
+       rds_encoder --capture [OPTIONS...] [--format ascii|packed|wav|f32|cu8|cs16|cf32] [--rate N]
+
+Description:
+  This program encodes RDS radio data for groups 0A and 2A with customizable settings.
+
+Group Selection:
+  -g 0A        Encode Group 0A (Basic tuning and switching information).
+  -g 2A        Encode Group 2A (Extended program information).
+
+Common Flags:
+  -pi VALUE    Program Identification (16-bit unsigned integerm range: 0-65535).
+               Example: -pi 12345
+
+  -pty VALUE   Program Type (5-bit unsigned integer, range: 0-31).
+               Example: -pty 4
+
+  -tp VALUE    Traffic Program flag (boolean: 0 or 1).
+               0: No traffic program, 1: Traffic program.
+               Example: -tp 1
+
+Group 0A-Specific Flags:
+  -ms VALUE    Music/Speech flag (boolean: 0 or 1).
+               0: Speech, 1: Music.
+               Example: -ms 1
+
+  -ta VALUE    Traffic Announcement flag (boolean: 0 or 1).
+               0: No announcement, 1: Traffic announcement in progress.
+               Example: -ta 0
+
+  -af F1,F2    Alternative Frequencies (two comma-separated float values with precision to 0.1).
+               Example: -af 104.5,98.0
+
+  -ps STRING   Program Service name (8-character string).
+               If shorter than 8 characters, it will be padded with spaces.
+               Example: -ps RadioXYZ
+
+Group 2A-Specific Flags:
+  -rt STRING   Radio Text (up to 64-character string).
+               If shorter than 8 characters, it will be padded with spaces.
+               Example: -rt "Now playing: Song Title"
+
+  -ab VALUE    Radio Text A/B flag (boolean: 0 or 1).
+               0: A version of the text, 1: B version of the text.
+               Example: -ab 0
+
+  --trim-rt    End a Radio Text shorter than 64 characters with a carriage
+               return (0x0D) and send only the segments up to it, e.g. 5
+               groups instead of 16 for a 19-character text.
+
+Batch Mode:
+  --batch [FILE]  Read one configuration per line from FILE (or standard input)
+               using the flags above, e.g. -g 0A -pi 4660 ... -ps "Radio XY",
+               and write one encoded record per line in ASCII format. Blank
+               lines produce an empty record. Invalid lines are reported on
+               stderr, produce an empty record and do not stop the batch.
+
+Carousel Mode:
+  --carousel [FILE]  Transmit a station continuously. FILE (or standard input)
+               holds a 0A line and/or a 2A line with the flags above, as in
+               batch mode. Groups are interleaved by weighted round-robin
+               and written without line breaks.
+  --weights W  Shares of the group types, e.g. 0A=4,2A=6 (the default).
+  --ct         Send a 4A clock time group at start and every minute.
+  --start T    UTC time of the first group as a Unix timestamp (default: now).
+  --offset N   Local time offset for 4A in half hours (default: 0).
+  --groups N   Stop after N groups (default: run until the output closes).
+  --realtime   Pace the output at the RDS rate of about 11.4 groups/s.
+  --updates F  Change the messages while transmitting. Every line of F is a
+               group number followed by a 0A or 2A configuration, which
+               replaces the message from that group on. The lines are in
+               order of group number and keep the PI of the station.
+  --stats      Print the share, longest gap and PS/RT rotation times of each
+               group type and the number of blocks encoded to stderr at the
+               end.
+
+Capture Mode:
+  --capture    Write a long synthetic reception for load tests: random
+               stations, each sending 0A, 2A and 4A groups through a
+               carousel, are visited in turn and their bits pass through a
+               simulated channel.
+  --groups N   Length of the capture in groups (default: 100000).
+  --stations N Number of stations, 1 to 1000 (default: 4).
+  --dwell N    Mean groups per visit of a station (default: 1000).
+  --ber P      Probability of an independent bit error (default: 0).
+  --bursts P   Probability per bit of a burst starting (default: 0).
+  --burst-length N    Longest burst in bits, half of its bits flip (default: 16).
+  --slips P    Probability per bit of a bit lost or repeated (default: 0).
+  --dropouts P Probability per bit of a dropout starting (default: 0).
+  --dropout-length N  Longest dropout in bits, received as random bits (default: 208).
+  --seed N     Seed of the stations and the channel (default: 1).
+  --truth F    Write the ground truth to F: the station of every visit, the
+               damage of every group and the groups sent per station.
+  --stats      Print the channel totals and the speed to stderr at the end.
+
+Output Format:
+  --format F   ascii (default) writes one '0' or '1' character per bit,
+               packed writes the bits MSB-first into bytes (13 bytes per group),
+               wav writes the RDS subcarrier signal: the bits are
+               differentially and biphase coded, shaped and modulated onto
+               57 kHz, as 16-bit mono PCM. The WAV length is filled in at the
+               end when writing to a file and left unknown on a pipe.
+               f32 writes the same signal as raw 32-bit float samples.
+               cu8, cs16 and cf32 write what an SDR receiver tuned to the
+               station records: the subcarrier frequency modulated at 5%
+               of the 75 kHz deviation, as interleaved unsigned 8-bit,
+               16-bit or float I/Q samples.
+  --wav        Same as --format wav.
+  --rate N     Sample rate of the signal formats in Hz, 128000 to 3200000
+               (default: 228000, e.g. 192000 for sound cards).
+
+Examples:
+  Encode Group 0A with music and alternative frequencies:
+    ./rds_encoder -g 0A -pi 12345 -pty 4 -tp 1 -ms 1 -ta 0 -af 104.5,98.0 -ps "RadioXYZ"
+
+  Encode Group 2A with basic settings:
+    ./rds_encoder -g 2A -pi 54321 -pty 10 -tp 0 -rt "Now Playing Song Title by Artist" -ab 0
+
+  Stream a station as a 192 kHz subcarrier signal to an exciter:
+    ./rds_encoder --carousel station.txt --realtime --wav --rate 192000 | aplay
+)";
+
+
+void Group2A::print_bits(BlockWriter &writer, BlockCache &cache) {
+  rds_2a_config config{};
+  config.pi = pi;
+  config.pty = pty;
+  config.tp = tp;
+  config.ab = ab;
+  std::copy_n(rt.begin(), std::min<size_t>(rt.size(), RDS_RT_LENGTH), config.rt);
+
+  cache.update_2a(config);
+  const uint32_t *blocks = cache.blocks_2a();
+  for (size_t i = 0; i < cache.segments_2a() * 4u; i++) writer.write_block(blocks[i]);
+}
+
+void Group0A::print_bits(BlockWriter &writer, BlockCache &cache) {
+  rds_0a_config config{};
+  config.pi = pi;
+  config.pty = pty;
+  config.tp = tp;
+  config.ms = ms;
+  config.ta = ta;
+  config.af1 = af1;
+  config.af2 = af2;
+  std::copy_n(ps.begin(), std::min<size_t>(ps.size(), RDS_PS_LENGTH), config.ps);
+
+  cache.update_0a(config);
+  const uint32_t *blocks = cache.blocks_0a();
+  for (size_t i = 0; i < RDS_0A_BLOCKS; i++) writer.write_block(blocks[i]);
+}
+
+bool is_frequency_format(const std::string &token) {
+  size_t length = token.size();
+  if (length != 4 && length != 5) return false;
+  for (size_t i = 0; i < length; i++) {
+    bool is_digit = token[i] >= '0' && token[i] <= '9';
+    if (i == length - 2 ? token[i] != '.' : !is_digit) return false;
   }
+  return true;
 }
 
-void Group0A::print_bits() {
-  uint32_t line{};
-  for (size_t b = 0; b < 4; b++) {
-    line = 0;
-    line |= static_cast<uint32_t>(pi) << 10;
-    line |= crc(line, offset_A);
-    print_26_bits(line);
-
-    line = 0;
-    line |= static_cast<uint32_t>(gt_vc) << 21;
-    line |= static_cast<uint32_t>(tp) << 20;
-    line |= static_cast<uint32_t>(pty) << 15;
-    line |= static_cast<uint32_t>(ta) << 14;
-    line |= static_cast<uint32_t>(ms) << 13;
-    line |= static_cast<uint32_t>(b) << 10;
-    line |= crc(line, offset_B);
-    print_26_bits(line);
-
-    line = 0;
-    if (b == 0) {
-      line |= static_cast<uint32_t>(af1) << 18;
-      line |= static_cast<uint32_t>(af2) << 10;
-    }
-    line |= crc(line, offset_C);
-    print_26_bits(line);
-
-    line = 0;
-    uint8_t c1 = static_cast<uint8_t>(ps[(b * 2)]);
-    uint8_t c2 = static_cast<uint8_t>(ps[(b * 2) + 1]);
-    line |= static_cast<uint32_t>(c1) << 18;
-    line |= static_cast<uint32_t>(c2) << 10;
-    line |= crc(line, offset_D);
-    print_26_bits(line);
+bool is_alphanumeric(const std::string &value) {
+  for (char c : value) {
+    if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == ' ')) return false;
   }
+  return true;
 }
 
 void ArgumentParser::parse_frequencies() {
@@ -96,8 +195,8 @@ void ArgumentParser::parse_frequencies() {
       break;
     }
 
-    // Check if the token matches the frequency regex
-    if (!std::regex_match(token, frequency_regex)) {
+    // Check if the token has the frequency format
+    if (!is_frequency_format(token)) {
       std::cerr << "Error: Invalid frequency format " << token << "\n";
       error = INVALID_FREQUENCIES;
       break;
@@ -158,7 +257,7 @@ int ArgumentParser::parse_string(const std::string &value, std::string &result,
     return -1;
   }
   // check if the string is only [a-zA-Z0-9]*
-  if (!std::regex_match(value, string_regex)) {
+  if (!is_alphanumeric(value)) {
     std::cerr << "Error: Invalid value " << value
               << " (must be alphanumeric)\n";
     error = INVALID_VALUE;
@@ -170,8 +269,42 @@ int ArgumentParser::parse_string(const std::string &value, std::string &result,
   return 0;
 }
 
-ArgumentParser::ArgumentParser(int argc, char *argv[]) : error(NO_ERROR) {
-  if (argc != 13 && argc != 17) {
+int parse_output_option(int argc, char *argv[], int &i, BitFormat &format, unsigned &sample_rate) {
+  std::string flag = argv[i];
+  if (flag == "--wav") {
+    format = FORMAT_WAV;
+    return 1;
+  }
+  if (flag == "--format" && i + 1 < argc) {
+    if (parse_format(argv[++i], format)) {
+      std::cerr << "Error: Invalid format " << argv[i] << "\n";
+      return -1;
+    }
+    return 1;
+  }
+  if (flag == "--rate" && i + 1 < argc) {
+    std::string value = argv[++i];
+    if (value.empty() || value.size() > 7 || value.find_first_not_of("0123456789") != std::string::npos ||
+        std::stoul(value) < min_sample_rate || std::stoul(value) > max_sample_rate) {
+      std::cerr << "Error: Invalid sample rate " << value << " (" << min_sample_rate << " to " << max_sample_rate << ")\n";
+      return -1;
+    }
+    sample_rate = static_cast<unsigned>(std::stoul(value));
+    return 1;
+  }
+  return 0;
+}
+
+ArgumentParser::ArgumentParser(int argc, char *argv[])
+    : groupType(UNKNOWN), error(NO_ERROR), format(FORMAT_ASCII), sample_rate(default_sample_rate), trim_rt(false) {
+  // options that do not describe the group are not part of the count
+  int option_args = 0;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if ((arg == "--format" || arg == "--rate") && i + 1 < argc) option_args += 2;
+    if (arg == "--wav" || arg == "--trim-rt") option_args++;
+  }
+  if (argc - option_args != 13 && argc - option_args != 17) {
     error = ARGUMENT_COUNT;
   }
   std::string groupID;
@@ -179,18 +312,22 @@ ArgumentParser::ArgumentParser(int argc, char *argv[]) : error(NO_ERROR) {
   // Iterate over command-line arguments and parse flags
   for (int i = 1; i < argc; ++i) {
     std::string flag = argv[i];
-    if (flag == "-g") {
-      groupID = argv[++i];
-      if (groupID != "0A" && groupID != "2A") {
-        std::cerr << "Error: Invalid group ID " << groupID << "\n";
-        error = UNSUPPORTED_GROUP;
-        break;
-      }
+    int output = parse_output_option(argc, argv, i, format, sample_rate);
+    if (output < 0) {
+      error = INVALID_VALUE;
+      break;
+    }
+    if (output > 0) {
+      continue;
+    } else if (flag == "--trim-rt") {
+      trim_rt = true;
+    } else if (flag == "-g") {
       if (i + 1 >= argc) {
         std::cerr << "Error: Missing value for " << flag << "\n";
         error = MISSING_VALUE;
         break;
       }
+      groupID = argv[++i];
       if (groupID == "0A") {
         groupType = GroupType::GROUP_0A;
       } else if (groupID == "2A") {
@@ -281,6 +418,12 @@ ArgumentParser::ArgumentParser(int argc, char *argv[]) : error(NO_ERROR) {
     return;
   }
 
+  if (groupType == UNKNOWN) {
+    std::cerr << "Error: Missing group flag\n";
+    error = MISSING_FLAG;
+    return;
+  }
+
   if ((flags & PI_FLAG) == 0) {
     std::cerr << "Error: Missing PI flag\n";
   }
@@ -337,7 +480,562 @@ ArgumentParser::ArgumentParser(int argc, char *argv[]) : error(NO_ERROR) {
         std::cerr << "Error: PS flag should not be present for Group 2A\n";
       }
     }
+    // a shorter text ends with a carriage return instead of padding
+    if (trim_rt && error == NO_ERROR && (flags & RT_FLAG)) {
+      size_t length = args["-rt"].size();
+      if (length < RDS_RT_LENGTH) rt[length] = RDS_RT_END;
+    }
+  }
+}
+
+int split_line(const std::string &line, std::vector<std::string> &tokens) {
+  size_t i = 0;
+  while (i < line.size()) {
+    if (line[i] == ' ' || line[i] == '\t' || line[i] == '\r') {
+      i++;
+      continue;
+    }
+    std::string token;
+    while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r') {
+      if (line[i] == '"') {
+        size_t end = line.find('"', i + 1);
+        if (end == std::string::npos) return -1;
+        token.append(line, i + 1, end - i - 1);
+        i = end + 1;
+      } else {
+        token.push_back(line[i++]);
+      }
+    }
+    tokens.push_back(token);
+  }
+  return 0;
+}
+
+int run_batch(std::istream &in) {
+  // the newline frames the records, so only ASCII output is written
+  BlockWriter writer(FORMAT_ASCII, STDOUT_FILENO, default_sample_rate);
+  // repeated lines of a station only re-encode the blocks that changed
+  std::unordered_map<uint16_t, BlockCache> stations;
+  std::string line;
+  std::vector<std::string> tokens;
+  std::vector<char *> line_argv;
+  char program_name[] = "rds_encoder";
+  unsigned line_number = 0;
+  int ret = 0;
+
+  while (std::getline(in, line)) {
+    line_number++;
+    tokens.clear();
+    line_argv.assign(1, program_name);
+    bool ok = split_line(line, tokens) == 0;
+    if (!ok) std::cerr << "Error: Unterminated quote\n";
+
+    if (ok && !tokens.empty()) {
+      for (std::string &token : tokens) line_argv.push_back(&token[0]);
+      // terminated like the argv of main()
+      line_argv.push_back(nullptr);
+      ArgumentParser parser(static_cast<int>(line_argv.size() - 1), line_argv.data());
+      ok = parser.error == ArgumentParser::NO_ERROR;
+      if (ok && parser.groupType == GroupType::GROUP_0A) {
+        Group0A group(parser.pi, parser.pty, parser.tp, parser.ms, parser.ta, parser.af1, parser.af2, parser.ps);
+        group.print_bits(writer, stations[parser.pi]);
+      } else if (ok && parser.groupType == GroupType::GROUP_2A) {
+        Group2A group(parser.pi, parser.pty, parser.tp, parser.rt, parser.ab);
+        group.print_bits(writer, stations[parser.pi]);
+      }
+    }
+
+    if (!ok) {
+      std::cerr << "Error: Line " << line_number << " skipped\n";
+      ret = 1;
+    }
+    writer.write_bytes("\n", 1);
+  }
+
+  writer.close();
+  return writer.good() ? ret : 1;
+}
+
+int parse_config(std::vector<std::string> &tokens, rds_0a_config &ps, rds_2a_config &rt) {
+  std::vector<char *> line_argv;
+  char program_name[] = "rds_encoder";
+  line_argv.push_back(program_name);
+  for (std::string &token : tokens) line_argv.push_back(&token[0]);
+  line_argv.push_back(nullptr);
+  ArgumentParser parser(static_cast<int>(line_argv.size() - 1), line_argv.data());
+  if (parser.error != ArgumentParser::NO_ERROR) return -1;
+
+  if (parser.groupType == GroupType::GROUP_0A) {
+    ps.pi = parser.pi;
+    ps.pty = parser.pty;
+    ps.tp = parser.tp;
+    ps.ms = parser.ms;
+    ps.ta = parser.ta;
+    ps.af1 = parser.af1;
+    ps.af2 = parser.af2;
+    std::copy_n(parser.ps.begin(), RDS_PS_LENGTH, ps.ps);
+  } else {
+    rt.pi = parser.pi;
+    rt.pty = parser.pty;
+    rt.tp = parser.tp;
+    rt.ab = parser.ab;
+    std::copy_n(parser.rt.begin(), RDS_RT_LENGTH, rt.rt);
+  }
+  return parser.groupType;
+}
+
+int parse_station(std::istream &in, CarouselConfig &config) {
+  std::string line;
+  std::vector<std::string> tokens;
+  bool has_0A = false;
+  bool has_2A = false;
+
+  while (std::getline(in, line)) {
+    tokens.clear();
+    if (split_line(line, tokens)) {
+      std::cerr << "Error: Unterminated quote\n";
+      return -1;
+    }
+    if (tokens.empty()) continue;
+    int type = parse_config(tokens, config.ps, config.rt);
+    if (type < 0) return -1;
+    has_0A |= type == GroupType::GROUP_0A;
+    has_2A |= type == GroupType::GROUP_2A;
+  }
+
+  if (!has_0A && !has_2A) {
+    std::cerr << "Error: No station configuration\n";
+    return -1;
+  }
+  if (has_0A && has_2A && config.ps.pi != config.rt.pi) {
+    std::cerr << "Error: PS and RT configurations must use the same PI\n";
+    return -1;
+  }
+  if (!has_0A) config.weight_0A = 0;
+  if (!has_2A) config.weight_2A = 0;
+  return 0;
+}
+
+int parse_updates(std::istream &in, const CarouselConfig &config, std::vector<StationUpdate> &updates) {
+  std::string line;
+  std::vector<std::string> tokens;
+  unsigned line_number = 0;
+  rds_0a_config ps = config.ps;
+  rds_2a_config rt = config.rt;
+
+  while (std::getline(in, line)) {
+    line_number++;
+    tokens.clear();
+    if (split_line(line, tokens)) {
+      std::cerr << "Error: Unterminated quote on update line " << line_number << "\n";
+      return -1;
+    }
+    if (tokens.empty()) continue;
+
+    const std::string &group = tokens.front();
+    if (group.empty() || group.size() > 18 || group.find_first_not_of("0123456789") != std::string::npos) {
+      std::cerr << "Error: Update line " << line_number << " does not start with a group number\n";
+      return -1;
+    }
+    StationUpdate update{};
+    update.group = std::stoull(group);
+    if (!updates.empty() && update.group < updates.back().group) {
+      std::cerr << "Error: Update line " << line_number << " is out of order\n";
+      return -1;
+    }
+    tokens.erase(tokens.begin());
+    int type = parse_config(tokens, ps, rt);
+    if (type < 0) {
+      std::cerr << "Error: Update line " << line_number << " is invalid\n";
+      return -1;
+    }
+    bool is_0A = type == GroupType::GROUP_0A;
+    uint16_t station_pi = config.weight_0A ? config.ps.pi : config.rt.pi;
+    if ((is_0A ? config.weight_0A : config.weight_2A) == 0 || (is_0A ? ps.pi : rt.pi) != station_pi) {
+      std::cerr << "Error: Update line " << line_number << " changes a message the carousel does not send\n";
+      return -1;
+    }
+    update.type = static_cast<GroupType>(type);
+    update.ps = ps;
+    update.rt = rt;
+    updates.push_back(update);
+  }
+  return 0;
+}
+
+int parse_weights(const std::string &value, CarouselConfig &config) {
+  std::stringstream ss(value);
+  std::string token;
+  while (std::getline(ss, token, ',')) {
+    size_t equals = token.find('=');
+    std::string group = token.substr(0, equals);
+    std::string weight = equals == std::string::npos ? "" : token.substr(equals + 1);
+    if (weight.empty() || weight.size() > 4 || weight.find_first_not_of("0123456789") != std::string::npos) return -1;
+    if (group == "0A") {
+      config.weight_0A = static_cast<unsigned>(std::stoi(weight));
+    } else if (group == "2A") {
+      config.weight_2A = static_cast<unsigned>(std::stoi(weight));
+    } else {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+void print_carousel_stats(const Carousel &carousel) {
+  const GroupScheduler &scheduler = carousel.get_scheduler();
+  double slots = static_cast<double>(scheduler.get_slot());
+  std::fprintf(stderr, "Groups: %llu in %.2f s\n", static_cast<unsigned long long>(scheduler.get_slot()), slots / group_rate);
+
+  const uint8_t codes[] = {group_type_code_0A, group_type_code_2A, group_type_code_4A};
+  const char *names[] = {"0A", "2A", "4A"};
+  for (size_t i = 0; i < 3; i++) {
+    int source = carousel.get_source(codes[i]);
+    if (source < 0) continue;
+    const SourceStats &stats = scheduler.get_stats(static_cast<size_t>(source));
+    std::fprintf(stderr, "%s: %llu groups (%.1f%%), max gap %.2f s", names[i], static_cast<unsigned long long>(stats.groups),
+                 slots ? 100.0 * static_cast<double>(stats.groups) / slots : 0.0, static_cast<double>(stats.max_gap) / group_rate);
+    if (codes[i] != group_type_code_4A && stats.rotations) {
+      std::fprintf(stderr, ", %s rotation worst %.2f s, mean %.2f s", i == 0 ? "PS" : "RT", static_cast<double>(stats.max_rotation) / group_rate,
+                   static_cast<double>(stats.total_rotation) / static_cast<double>(stats.rotations) / group_rate);
+    }
+    std::fprintf(stderr, "\n");
+  }
+  std::fprintf(stderr, "Blocks encoded: %llu\n", static_cast<unsigned long long>(carousel.get_encoded()));
+}
+
+int run_carousel(int argc, char *argv[]) {
+  CarouselConfig config{};
+  config.weight_0A = default_weight_0A;
+  config.weight_2A = default_weight_2A;
+  config.start_time = std::time(nullptr);
+  BitFormat format = FORMAT_ASCII;
+  unsigned sample_rate = default_sample_rate;
+  std::string path;
+  std::string updates_path;
+  std::vector<StationUpdate> updates;
+  uint64_t groups = 0;
+  bool realtime = false;
+  bool stats = false;
+
+  for (int i = 2; i < argc; i++) {
+    std::string flag = argv[i];
+    std::string value = i + 1 < argc ? argv[i + 1] : "";
+    bool is_number = !value.empty() && value.size() <= 18 && value.find_first_not_of("0123456789") == std::string::npos;
+    int output = parse_output_option(argc, argv, i, format, sample_rate);
+    if (output < 0) return 1;
+    if (output > 0) {
+      continue;
+    } else if (flag == "--weights" && i + 1 < argc) {
+      if (parse_weights(argv[++i], config)) {
+        std::cerr << "Error: Invalid weights " << argv[i] << " (e.g. 0A=4,2A=6)\n";
+        return 1;
+      }
+    } else if (flag == "--groups" && is_number) {
+      groups = std::stoull(argv[++i]);
+    } else if (flag == "--start" && is_number) {
+      config.start_time = static_cast<time_t>(std::stoll(argv[++i]));
+    } else if (flag == "--offset" && i + 1 < argc) {
+      int offset{};
+      try {
+        offset = std::stoi(argv[++i]);
+      } catch (const std::exception &e) {
+        offset = 100;
+      }
+      if (offset < -31 || offset > 31) {
+        std::cerr << "Error: Invalid offset " << argv[i] << " (half hours, -31 to 31)\n";
+        return 1;
+      }
+      config.local_offset = static_cast<int8_t>(offset);
+    } else if (flag == "--updates" && i + 1 < argc) {
+      updates_path = argv[++i];
+    } else if (flag == "--ct") {
+      config.clock = true;
+    } else if (flag == "--realtime") {
+      realtime = true;
+    } else if (flag == "--stats") {
+      stats = true;
+    } else if (path.empty() && flag.compare(0, 1, "-") != 0) {
+      path = flag;
+    } else {
+      std::cerr << "Error: Unknown flag " << flag << "\n";
+      return 1;
+    }
+  }
+
+  std::ifstream file;
+  if (!path.empty()) {
+    file.open(path);
+    if (!file) {
+      std::cerr << "Error: Cannot open " << path << "\n";
+      return 1;
+    }
+  }
+  if (parse_station(path.empty() ? std::cin : file, config)) return 1;
+  if (!config.weight_0A && !config.weight_2A) {
+    std::cerr << "Error: At least one of 0A and 2A needs a weight\n";
+    return 1;
+  }
+  if (!updates_path.empty()) {
+    std::ifstream updates_file(updates_path);
+    if (!updates_file) {
+      std::cerr << "Error: Cannot open " << updates_path << "\n";
+      return 1;
+    }
+    if (parse_updates(updates_file, config, updates)) return 1;
   }
+
+  Carousel carousel(config);
+  BlockWriter writer(format, STDOUT_FILENO, sample_rate);
+  uint32_t group[4];
+  size_t next_update = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint64_t n = 0; (groups == 0 || n < groups) && writer.good(); n++) {
+    for (; next_update < updates.size() && updates[next_update].group <= n; next_update++) {
+      const StationUpdate &update = updates[next_update];
+      if (update.type == GroupType::GROUP_0A) {
+        carousel.update_0a(update.ps);
+      } else {
+        carousel.update_2a(update.rt);
+      }
+    }
+    carousel.next_group(group);
+    for (uint32_t block : group) writer.write_block(block);
+    if (realtime) {
+      // hold every group back until its slot on air
+      writer.flush();
+      std::this_thread::sleep_until(start + std::chrono::duration<double>(static_cast<double>(n + 1) / group_rate));
+    }
+  }
+  writer.close();
+  if (stats) print_carousel_stats(carousel);
+  return writer.good() ? 0 : 1;
+}
+
+void random_station(std::mt19937 &random, uint16_t pi, CarouselConfig &config) {
+  static const char letters[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+  static const char *words[] = {"Now",   "playing", "Song", "Title", "by",    "Artist", "News",  "at",    "the",   "top",
+                                "of",    "hour",    "Live", "from",  "Radio", "Traffic", "update", "Weather", "sunny", "and"};
+  config = CarouselConfig{};
+  config.ps.pi = pi;
+  config.ps.pty = static_cast<uint8_t>(random() % 32);
+  config.ps.tp = static_cast<uint8_t>(random() % 2);
+  config.ps.ms = static_cast<uint8_t>(random() % 2);
+  config.ps.ta = static_cast<uint8_t>(config.ps.tp && random() % 4 == 0);
+  config.ps.af1 = static_cast<uint8_t>(1 + random() % 204);
+  config.ps.af2 = static_cast<uint8_t>(1 + random() % 204);
+  for (char &c : config.ps.ps) c = letters[random() % (sizeof(letters) - 1)];
+
+  config.rt.pi = pi;
+  config.rt.pty = config.ps.pty;
+  config.rt.tp = config.ps.tp;
+  config.rt.ab = static_cast<uint8_t>(random() % 2);
+  std::string text = words[random() % 20];
+  size_t length = 8 + random() % 50;
+  while (text.size() < length) text += std::string(" ") + words[random() % 20];
+  text = text.substr(0, std::min<size_t>(text.size(), RDS_RT_LENGTH - 1)) + static_cast<char>(RDS_RT_END);
+  std::fill_n(config.rt.rt, RDS_RT_LENGTH, ' ');
+  std::copy(text.begin(), text.end(), config.rt.rt);
+
+  config.weight_0A = 1 + static_cast<unsigned>(random() % default_weight_0A);
+  config.weight_2A = 1 + static_cast<unsigned>(random() % default_weight_2A);
+  config.clock = pi % 2 == 0;
+  config.start_time = 1767225600; // 2026-01-01
+}
+
+/**
+ * Appends a decimal number.
+ * @param out Where the digits go.
+ * @param value The number.
+ * @return The position after the last digit.
+ */
+static char *append_number(char *out, uint64_t value) {
+  char digits[20];
+  size_t count = 0;
+  do {
+    digits[count++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value);
+  while (count) *out++ = digits[--count];
+  return out;
+}
+
+/**
+ * Parses a probability per bit for capture mode.
+ * @param value The text, e.g. 0.001 or 1e-4.
+ * @param rate Output.
+ * @return 0 on success, -1 if it is not a number from 0 to 0.5
+ */
+static int parse_probability(const std::string &value, double &rate) {
+  char *end = nullptr;
+  rate = std::strtod(value.c_str(), &end);
+  if (value.empty() || *end != '\0' || !(rate >= 0 && rate <= 0.5)) return -1;
+  return 0;
+}
+
+int run_capture(int argc, char *argv[]) {
+  ChannelConfig channel_config{};
+  channel_config.burst_length = default_burst_length;
+  channel_config.dropout_length = default_dropout_length;
+  channel_config.seed = 1;
+  BitFormat format = FORMAT_ASCII;
+  unsigned sample_rate = default_sample_rate;
+  uint64_t groups = default_capture_groups;
+  unsigned station_count = default_capture_stations;
+  unsigned dwell = default_dwell;
+  std::string truth_path;
+  bool stats = false;
+
+  for (int i = 2; i < argc; i++) {
+    std::string flag = argv[i];
+    std::string value = i + 1 < argc ? argv[i + 1] : "";
+    bool is_number = !value.empty() && value.size() <= 18 && value.find_first_not_of("0123456789") == std::string::npos;
+    double *rate = flag == "--ber" ? &channel_config.bit_error_rate : flag == "--bursts" ? &channel_config.burst_rate
+                 : flag == "--slips" ? &channel_config.slip_rate : flag == "--dropouts" ? &channel_config.dropout_rate : nullptr;
+    int output = parse_output_option(argc, argv, i, format, sample_rate);
+    if (output < 0) return 1;
+    if (output > 0) {
+      continue;
+    } else if (rate && i + 1 < argc) {
+      if (parse_probability(argv[++i], *rate)) {
+        std::cerr << "Error: Invalid probability " << argv[i] << " for " << flag << " (0 to 0.5)\n";
+        return 1;
+      }
+    } else if (flag == "--groups" && is_number && std::stoull(value) > 0) {
+      groups = std::stoull(argv[++i]);
+    } else if (flag == "--stations" && is_number && std::stoull(value) > 0 && std::stoull(value) <= max_capture_stations) {
+      station_count = static_cast<unsigned>(std::stoul(argv[++i]));
+    } else if ((flag == "--dwell" || flag == "--burst-length" || flag == "--dropout-length") && is_number && value.size() <= 9 &&
+               std::stoul(value) > 0) {
+      unsigned number = static_cast<unsigned>(std::stoul(argv[++i]));
+      (flag == "--dwell" ? dwell : flag == "--burst-length" ? channel_config.burst_length : channel_config.dropout_length) = number;
+    } else if (flag == "--seed" && is_number) {
+      channel_config.seed = std::stoull(argv[++i]);
+    } else if (flag == "--truth" && i + 1 < argc) {
+      truth_path = argv[++i];
+    } else if (flag == "--stats") {
+      stats = true;
+    } else {
+      std::cerr << "Error: Unknown flag or invalid value " << flag << "\n";
+      return 1;
+    }
+  }
+
+  int truth_fd = -1;
+  if (!truth_path.empty()) {
+    truth_fd = open(truth_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (truth_fd < 0) {
+      std::cerr << "Error: Cannot open " << truth_path << "\n";
+      return 1;
+    }
+  }
+
+  // distinct PI codes, one station per PI
+  std::mt19937 random(static_cast<uint32_t>(channel_config.seed));
+  std::vector<uint16_t> codes;
+  std::vector<CarouselConfig> configs;
+  std::vector<Carousel> stations;
+  while (codes.size() < station_count) {
+    uint16_t pi = static_cast<uint16_t>(1 + random() % 0xFFFF);
+    if (std::find(codes.begin(), codes.end(), pi) != codes.end()) continue;
+    CarouselConfig config;
+    random_station(random, pi, config);
+    codes.push_back(pi);
+    configs.push_back(config);
+    stations.emplace_back(config);
+  }
+  std::vector<uint64_t> sent(station_count, 0);
+  std::vector<uint64_t> intact(station_count, 0);
+
+  Channel channel(channel_config);
+  BlockWriter writer(format, STDOUT_FILENO, sample_rate);
+  std::unique_ptr<BlockWriter> truth;
+  if (truth_fd >= 0) truth.reset(new BlockWriter(FORMAT_ASCII, truth_fd));
+  char line[256];
+  size_t station = 0;
+  uint64_t visit_end = 0;
+  auto start = std::chrono::steady_clock::now();
+
+  for (uint64_t n = 0; n < groups && writer.good(); n++) {
+    if (n == visit_end) {
+      // tune to another station, which may have changed its Radio Text meanwhile
+      if (station_count > 1) station = (station + 1 + random() % (station_count - 1)) % station_count;
+      visit_end = n + 1 + random() % (2 * dwell);
+      if (n > 0 && random() % 2) {
+        CarouselConfig changed;
+        random_station(random, codes[station], changed);
+        rds_2a_config &rt = configs[station].rt;
+        std::copy_n(changed.rt.rt, RDS_RT_LENGTH, rt.rt);
+        rt.ab = static_cast<uint8_t>(!rt.ab);
+        stations[station].update_2a(rt);
+      }
+      if (truth) {
+        std::string ps(configs[station].ps.ps, RDS_PS_LENGTH);
+        std::string rt(configs[station].rt.rt, RDS_RT_LENGTH);
+        rt = rt.substr(0, rt.find(RDS_RT_END));
+        int length = std::snprintf(line, sizeof(line), "S %llu %u \"%s\" \"%s\"\n", static_cast<unsigned long long>(channel.get_stats().bits_out),
+                                   codes[station], ps.c_str(), rt.c_str());
+        truth->write_bytes(line, static_cast<size_t>(length));
+      }
+    }
+
+    uint32_t group[4];
+    uint64_t bit = channel.get_stats().bits_out;
+    uint8_t code = stations[station].next_group(group);
+    unsigned events = 0;
+    unsigned flipped = 0;
+    for (uint32_t block : group) {
+      unsigned block_flipped;
+      events |= channel.transmit(block, writer, block_flipped);
+      flipped += block_flipped;
+    }
+    sent[station]++;
+    if (!events) intact[station]++;
+    if (!truth) continue;
+
+    char *out = line;
+    *out++ = 'G';
+    *out++ = ' ';
+    out = append_number(out, bit);
+    *out++ = ' ';
+    out = append_number(out, codes[station]);
+    *out++ = ' ';
+    group_name(code, out);
+    out += std::strlen(out);
+    *out++ = ' ';
+    out = append_number(out, flipped);
+    *out++ = ' ';
+    const char event_names[] = "fbsd";
+    for (unsigned e = 0; e < 4; e++) {
+      if (events & (1u << e)) *out++ = event_names[e];
+    }
+    if (!events) *out++ = '-';
+    *out++ = '\n';
+    truth->write_bytes(line, static_cast<size_t>(out - line));
+  }
+  writer.close();
+
+  if (truth) {
+    for (size_t s = 0; s < station_count; s++) {
+      int length = std::snprintf(line, sizeof(line), "T %u %llu %llu\n", codes[s], static_cast<unsigned long long>(sent[s]),
+                                 static_cast<unsigned long long>(intact[s]));
+      truth->write_bytes(line, static_cast<size_t>(length));
+    }
+    truth->close();
+    close(truth_fd);
+  }
+
+  if (stats) {
+    const ChannelStats &totals = channel.get_stats();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "Groups: %llu of %u stations, %llu bits sent, %llu received\n", static_cast<unsigned long long>(groups), station_count,
+                 static_cast<unsigned long long>(totals.bits_in), static_cast<unsigned long long>(totals.bits_out));
+    std::fprintf(stderr, "Channel: %llu bits flipped, %llu bursts, %llu slips, %llu dropouts\n", static_cast<unsigned long long>(totals.flipped),
+                 static_cast<unsigned long long>(totals.bursts), static_cast<unsigned long long>(totals.slips),
+                 static_cast<unsigned long long>(totals.dropouts));
+    std::fprintf(stderr, "Time: %.2f s, %.0f groups/s\n", seconds, static_cast<double>(groups) / seconds);
+  }
+  return writer.good() && (!truth || truth->good()) ? 0 : 1;
 }
 
 int main(int argc, char *argv[]) {
@@ -350,20 +1048,60 @@ int main(int argc, char *argv[]) {
     std::cout << helpMessage;
     return 0;
   }
+  if (first_arg == "--carousel") {
+    return run_carousel(argc, argv);
+  }
+  if (first_arg == "--capture") {
+    return run_capture(argc, argv);
+  }
+  if (first_arg == "--batch") {
+    std::string path;
+    BitFormat format = FORMAT_ASCII;
+    unsigned sample_rate = default_sample_rate;
+    for (int i = 2; i < argc; i++) {
+      std::string flag = argv[i];
+      int output = parse_output_option(argc, argv, i, format, sample_rate);
+      if (output < 0) return 1;
+      if (output > 0) {
+        continue;
+      } else if (path.empty() && flag.compare(0, 1, "-") != 0) {
+        path = flag;
+      } else {
+        std::cerr << "Error: Unknown flag " << flag << "\n";
+        return 1;
+      }
+    }
+    if (format != FORMAT_ASCII) {
+      std::cerr << "Error: Batch mode writes one line per record and supports only --format ascii\n";
+      return 1;
+    }
+    std::ios::sync_with_stdio(false);
+    if (path.empty()) return run_batch(std::cin);
+    std::ifstream file(path);
+    if (!file) {
+      std::cerr << "Error: Cannot open " << path << "\n";
+      return 1;
+    }
+    return run_batch(file);
+  }
+
   auto parser = ArgumentParser(argc, argv);
   if (parser.error != ArgumentParser::NO_ERROR) {
     return 1;
   }
 
+  BlockWriter writer(parser.format, STDOUT_FILENO, parser.sample_rate);
+  BlockCache cache;
   if (parser.groupType == GroupType::GROUP_0A) {
     Group0A group(parser.pi, parser.pty, parser.tp, parser.ms, parser.ta,
                   parser.af1, parser.af2, parser.ps);
-    group.print_bits();
+    group.print_bits(writer, cache);
 
   } else if (parser.groupType == GroupType::GROUP_2A) {
     Group2A group(parser.pi, parser.pty, parser.tp, parser.rt, parser.ab);
-    group.print_bits();
+    group.print_bits(writer, cache);
   }
 
-  return 0;
+  writer.close();
+  return writer.good() ? 0 : 1;
 }
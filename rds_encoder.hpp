@@ -15,73 +15,164 @@
 
 #include <algorithm>
 #include <bitset>
+#include <chrono>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
-#include <regex>
+#include <random>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
+#include "bitstream.hpp"
 #include "common.hpp"
+#include "rds.h"
+#include "rds_cache.hpp"
+#include "rds_channel.hpp"
+#include "rds_scheduler.hpp"
 
-const char *helpMessage = R"(
-Usage: rds_encoder -g [GROUP] [FLAGS...]
-
-Description:
-  This program encodes RDS radio data for groups 0A and 2A with customizable settings.
+/**
+ * Checks the format of a frequency, two or three digits, a decimal point
+ * and one more digit (e.g. 98.0 or 104.5).
+ * @param token The frequency string.
+ * @return true if the format is valid.
+ */
+bool is_frequency_format(const std::string &token);
 
-Group Selection:
-  -g 0A        Encode Group 0A (Basic tuning and switching information).
-  -g 2A        Encode Group 2A (Extended program information).
+/**
+ * Checks that a string holds only letters, digits and spaces.
+ * @param value The string.
+ * @return true if every character is allowed.
+ */
+bool is_alphanumeric(const std::string &value);
 
-Common Flags:
-  -pi VALUE    Program Identification (16-bit unsigned integerm range: 0-65535).
-               Example: -pi 12345
+/**
+ * Splits a batch line into arguments at whitespace. Double quotes group
+ * words, so -ps "Radio XY" and -rt "" work as on a shell command line.
+ * @param line The line.
+ * @param tokens The arguments, appended.
+ * @return 0 on success, -1 if a quote is not closed.
+ */
+int split_line(const std::string &line, std::vector<std::string> &tokens);
 
-  -pty VALUE   Program Type (5-bit unsigned integer, range: 0-31).
-               Example: -pty 4
+/**
+ * Encodes one station configuration per line, with the same flags as the
+ * command line, and writes one record per line: the encoded groups in ASCII
+ * followed by a newline. Blank lines produce an empty record; lines that fail
+ * to parse are reported on stderr and produce an empty record too, so records
+ * keep their line numbers.
+ * @param in The configurations.
+ * @return 0 if every line was encoded, 1 otherwise
+ */
+int run_batch(std::istream &in);
 
-  -tp VALUE    Traffic Program flag (boolean: 0 or 1).
-               0: No traffic program, 1: Traffic program.
-               Example: -tp 1
+/**
+ * Parses an output option, --format F, --wav or --rate N, at argv[i].
+ * @param argc Argument count.
+ * @param argv Argument values.
+ * @param i Index of the option, moved to its value if it has one.
+ * @param format Output format, set by --format and --wav.
+ * @param sample_rate Samples per second, set by --rate.
+ * @return 1 if argv[i] is an output option, 0 if not, -1 on an invalid value
+ */
+int parse_output_option(int argc, char *argv[], int &i, BitFormat &format, unsigned &sample_rate);
+
+/** A change of a carousel message from a given group on. */
+struct StationUpdate {
+  uint64_t group;   /**< Index of the first group with the change */
+  GroupType type;   /**< GROUP_0A or GROUP_2A, the message changed */
+  rds_0a_config ps; /**< New PS message, for GROUP_0A */
+  rds_2a_config rt; /**< New RT message, for GROUP_2A */
+};
 
-Group 0A-Specific Flags:
-  -ms VALUE    Music/Speech flag (boolean: 0 or 1).
-               0: Speech, 1: Music.
-               Example: -ms 1
+/**
+ * Parses the flags of one 0A or 2A configuration line.
+ * @param tokens The flags, without the program name.
+ * @param ps The PS message, filled in for a 0A line.
+ * @param rt The RT message, filled in for a 2A line.
+ * @return GROUP_0A or GROUP_2A, -1 on invalid flags
+ */
+int parse_config(std::vector<std::string> &tokens, rds_0a_config &ps, rds_2a_config &rt);
 
-  -ta VALUE    Traffic Announcement flag (boolean: 0 or 1).
-               0: No announcement, 1: Traffic announcement in progress.
-               Example: -ta 0
+/**
+ * Reads the station of the carousel, a 0A and/or a 2A configuration line
+ * with the same flags as the command line. The weight of a group type
+ * without a line is cleared.
+ * @param in The configuration lines.
+ * @param config The carousel configuration, filled in.
+ * @return 0 on success, -1 on an invalid configuration
+ */
+int parse_station(std::istream &in, CarouselConfig &config);
 
-  -af F1,F2    Alternative Frequencies (two comma-separated float values with precision to 0.1).
-               Example: -af 104.5,98.0
+/**
+ * Reads the message changes of the carousel, one per line: the group
+ * number from which the change applies, then a 0A or 2A configuration.
+ * Only the messages the carousel sends can change and the PI stays.
+ * @param in The update lines, in order of group number.
+ * @param config The carousel configuration.
+ * @param updates Output, the parsed changes.
+ * @return 0 on success, -1 on an invalid line
+ */
+int parse_updates(std::istream &in, const CarouselConfig &config, std::vector<StationUpdate> &updates);
 
-  -ps STRING   Program Service name (8-character string).
-               If shorter than 8 characters, it will be padded with spaces.
-               Example: -ps RadioXYZ
+/**
+ * Parses the shares of the carousel group types, e.g. 0A=4,2A=6.
+ * @param value The weights string.
+ * @param config The carousel configuration, weights are set.
+ * @return 0 on success, -1 on an invalid string
+ */
+int parse_weights(const std::string &value, CarouselConfig &config);
 
-Group 2A-Specific Flags:
-  -rt STRING   Radio Text (up to 64-character string).
-               If shorter than 8 characters, it will be padded with spaces.
-               Example: -rt "Now playing: Song Title"
+/**
+ * Prints the share, longest gap and rotation times of each group type
+ * sent by a carousel to stderr.
+ * @param carousel The carousel.
+ */
+void print_carousel_stats(const Carousel &carousel);
 
-  -ab VALUE    Radio Text A/B flag (boolean: 0 or 1).
-               0: A version of the text, 1: B version of the text.
-               Example: -ab 0
+/**
+ * Transmits a station continuously, see the Carousel Mode section of the
+ * help message for the options.
+ * @param argc Argument count from main().
+ * @param argv Argument values from main(), argv[1] is --carousel.
+ * @return 0 on success, 1 on an invalid configuration or write error
+ */
+int run_carousel(int argc, char *argv[]);
 
-Examples:
-  Encode Group 0A with music and alternative frequencies:
-    ./rds_encoder -g 0A -pi 12345 -pty 4 -tp 1 -ms 1 -ta 0 -af 104.5,98.0 -ps "RadioXYZ"
+/**
+ * Makes up a station for capture mode: random flags, a PS of letters and
+ * digits, a Radio Text of random words ended by a carriage return, random
+ * shares of 0A and 2A and, for every other station, 4A clock time.
+ * @param random The generator.
+ * @param pi PI code of the station.
+ * @param config Output, the carousel configuration.
+ */
+void random_station(std::mt19937 &random, uint16_t pi, CarouselConfig &config);
 
-  Encode Group 2A with basic settings:
-    ./rds_encoder -g 2A -pi 54321 -pty 10 -tp 0 -rt "Now Playing Song Title by Artist" -ab 0
-)";
+/**
+ * Writes a long synthetic reception of several stations through a
+ * simulated channel, and optionally its ground truth, see the Capture Mode
+ * section of the help message for the options.
+ * @param argc Argument count from main().
+ * @param argv Argument values from main(), argv[1] is --capture.
+ * @return 0 on success, 1 on an invalid option or write error
+ */
+int run_capture(int argc, char *argv[]);
 
-const std::regex frequency_regex(R"(^\d{2,3}\.\d$)");
-const std::regex string_regex("^[a-zA-Z0-9 ]*$");
+const unsigned default_weight_0A = 4; /**< Default carousel share of 0A groups */
+const unsigned default_weight_2A = 6; /**< Default carousel share of 2A groups */
+const uint64_t default_capture_groups = 100000; /**< Default length of a capture in groups */
+const unsigned default_capture_stations = 4;    /**< Default number of stations in a capture */
+const unsigned max_capture_stations = 1000;     /**< Most stations in a capture */
+const unsigned default_dwell = 1000;            /**< Default mean groups per visit of a station */
+const unsigned default_burst_length = 16;       /**< Default longest burst error in bits */
+const unsigned default_dropout_length = 208;    /**< Default longest dropout in bits, two groups */
 
 // no decimal point for comparison with integer
 const double MIN_FREQUENCY = 876;
@@ -123,8 +214,10 @@ public:
         pty(program_type) {}
   /**
    * Virtual function to print bits of the group.
+   * @param writer Destination of the encoded blocks.
+   * @param cache Encoded blocks of the station, only changed blocks are re-encoded.
    */
-  virtual void print_bits() = 0;
+  virtual void print_bits(BlockWriter &writer, BlockCache &cache) = 0;
 
 protected:
   uint8_t gt_vc; /**< Group Type Code + Version Code. */
@@ -161,8 +254,10 @@ public:
 
   /**
    * Override function to print bits of Group 2A.
+   * @param writer Destination of the encoded blocks.
+   * @param cache Encoded blocks of the station, only changed blocks are re-encoded.
    */
-  void print_bits() override;
+  void print_bits(BlockWriter &writer, BlockCache &cache) override;
 };
 
 /**
@@ -199,8 +294,10 @@ public:
 
   /**
    * Function to print bits of Group 0A.
+   * @param writer Destination of the encoded blocks.
+   * @param cache Encoded blocks of the station, only changed blocks are re-encoded.
    */
-  void print_bits() override;
+  void print_bits(BlockWriter &writer, BlockCache &cache) override;
 };
 
 /**
@@ -227,6 +324,9 @@ public:
   argsMap args;        /**< Map storing parsed arguments. */
   GroupType groupType; /**< Parsed group type. */
   Error error;         /**< Error status during parsing. */
+  BitFormat format;    /**< Output format. */
+  unsigned sample_rate; /**< Samples per second in WAV and f32 format. */
+  bool trim_rt;        /**< End a short RT with RDS_RT_END instead of padding. */
 
   /* Common fields */
   uint16_t pi; /**< Program Identification (PI). */
@@ -265,7 +365,7 @@ public:
    * 
    * Error conditions:
    * - More than two frequencies are provided.
-   * - Frequency format does not match the expected regex.
+   * - Frequency format does not match is_frequency_format().
    * - Frequency is out of the valid range.
    * - Less than two valid frequencies are provided.
    */
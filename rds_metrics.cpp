@@ -0,0 +1,222 @@
+/**
+ * @file       rds_metrics.cpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Runtime counters and stage timings of the decoder
+ *
+ * @date      17 October  2026 \n
+ */
+
+#include "rds_metrics.hpp"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+thread_local MetricShard *metric_shard = nullptr;
+
+/** Innermost running StageTimer of the thread. */
+static thread_local StageTimer *current_timer = nullptr;
+
+/** Names of the offsets and the stages in the output. */
+static const char *offset_names[] = {"A", "B", "C", "C'", "D"};
+static const char *stage_names[] = {"read", "parse", "demodulate", "synchronize", "decode"};
+
+/** Every shard ever created, guarded by shard_mutex. */
+static std::mutex shard_mutex;
+static std::vector<MetricShard *> shards;
+static std::chrono::steady_clock::time_point start_time;
+
+MetricShard *register_metric_shard() {
+  // C++14 new ignores the cache line alignment
+  void *memory = nullptr;
+  if (posix_memalign(&memory, alignof(MetricShard), sizeof(MetricShard)) != 0) throw std::bad_alloc();
+  std::memset(memory, 0, sizeof(MetricShard));
+  metric_shard = new (memory) MetricShard;
+  std::lock_guard<std::mutex> lock(shard_mutex);
+  if (shards.empty()) start_time = std::chrono::steady_clock::now();
+  shards.push_back(metric_shard);
+  return metric_shard;
+}
+
+void count_group(const uint32_t *group) {
+  MetricShard &shard = thread_metrics();
+  metric_add(shard.groups[get_group_code(group[1])]);
+  uint32_t pi = GroupLayout::Pi::extract(group);
+  std::atomic<uint64_t> &word = shard.pi_seen[pi / 64];
+  word.store(word.load(std::memory_order_relaxed) | (static_cast<uint64_t>(1) << (pi % 64)), std::memory_order_relaxed);
+}
+
+StageTimer::StageTimer(MetricStage stage) : stage(stage), start(std::chrono::steady_clock::now()), nested_ns(0), outer(current_timer) {
+  current_timer = this;
+}
+
+StageTimer::~StageTimer() {
+  uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+  MetricShard &shard = thread_metrics();
+  metric_add(shard.stage_ns[stage], elapsed - std::min(elapsed, nested_ns));
+  metric_add(shard.stage_calls[stage]);
+  current_timer = outer;
+  if (outer) outer->nested_ns += elapsed;
+}
+
+MetricSnapshot collect_metrics() {
+  thread_metrics();
+  MetricSnapshot snapshot{};
+  std::vector<uint64_t> pi_seen(65536 / 64, 0);
+  std::lock_guard<std::mutex> lock(shard_mutex);
+  snapshot.uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  for (const MetricShard *shard : shards) {
+    for (int i = 0; i < metric_counter_count; i++) snapshot.counters[i] += shard->counters[i].load(std::memory_order_relaxed);
+    for (unsigned i = 0; i < group_type_codes; i++) snapshot.groups[i] += shard->groups[i].load(std::memory_order_relaxed);
+    for (int i = 0; i < metric_stage_count; i++) {
+      snapshot.stage_seconds[i] += static_cast<double>(shard->stage_ns[i].load(std::memory_order_relaxed)) / 1e9;
+      snapshot.stage_calls[i] += shard->stage_calls[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < pi_seen.size(); i++) pi_seen[i] |= shard->pi_seen[i].load(std::memory_order_relaxed);
+  }
+  for (uint64_t word : pi_seen) snapshot.unique_pis += static_cast<uint64_t>(__builtin_popcountll(word));
+  return snapshot;
+}
+
+/**
+ * Appends formatted text.
+ * @param out The text.
+ * @param format printf format.
+ */
+__attribute__((format(printf, 2, 3))) static void append(std::string &out, const char *format, ...) {
+  char line[256];
+  va_list args;
+  va_start(args, format);
+  int length = std::vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  out.append(line, static_cast<size_t>(std::max(0, std::min(length, static_cast<int>(sizeof(line)) - 1))));
+}
+
+std::string format_metrics_json(const MetricSnapshot &snapshot) {
+  const uint64_t *c = snapshot.counters;
+  std::string out;
+  append(out, "{\"uptime_seconds\": %.3f, \"blocks\": %llu, \"blocks_per_offset\": {", snapshot.uptime, static_cast<unsigned long long>(c[METRIC_BLOCKS]));
+  for (int i = 0; i < 5; i++) append(out, "%s\"%s\": %llu", i ? ", " : "", offset_names[i], static_cast<unsigned long long>(c[METRIC_OFFSET_A + i]));
+  append(out, "}, \"crc_failures\": %llu, \"corrected_blocks\": %llu, \"sync_losses\": %llu, \"groups\": {",
+         static_cast<unsigned long long>(c[METRIC_CRC_FAILURES]), static_cast<unsigned long long>(c[METRIC_CORRECTED]),
+         static_cast<unsigned long long>(c[METRIC_SYNC_LOSSES]));
+  bool first = true;
+  for (uint8_t code = 0; code < group_type_codes; code++) {
+    if (!snapshot.groups[code]) continue;
+    char name[4];
+    group_name(code, name);
+    append(out, "%s\"%s\": %llu", first ? "" : ", ", name, static_cast<unsigned long long>(snapshot.groups[code]));
+    first = false;
+  }
+  append(out, "}, \"unique_pis\": %llu, \"messages\": %llu, \"decode_errors\": %llu, \"stages\": {",
+         static_cast<unsigned long long>(snapshot.unique_pis), static_cast<unsigned long long>(c[METRIC_MESSAGES]),
+         static_cast<unsigned long long>(c[METRIC_DECODE_ERRORS]));
+  for (int i = 0; i < metric_stage_count; i++) {
+    append(out, "%s\"%s\": {\"seconds\": %.6f, \"calls\": %llu}", i ? ", " : "", stage_names[i], snapshot.stage_seconds[i],
+           static_cast<unsigned long long>(snapshot.stage_calls[i]));
+  }
+  out += "}}\n";
+  return out;
+}
+
+/**
+ * Appends the HELP and TYPE lines of a Prometheus metric.
+ * @param out The text.
+ * @param name Name of the metric.
+ * @param type counter or gauge.
+ * @param help Description.
+ */
+static void describe(std::string &out, const char *name, const char *type, const char *help) {
+  append(out, "# HELP rds_%s %s\n# TYPE rds_%s %s\n", name, help, name, type);
+}
+
+std::string format_metrics_prometheus(const MetricSnapshot &snapshot) {
+  struct Simple {
+    const char *name;
+    MetricCounter counter;
+    const char *help;
+  };
+  static const Simple simple[] = {
+      {"blocks_total", METRIC_BLOCKS, "Blocks checked against their offset word."},
+      {"crc_failures_total", METRIC_CRC_FAILURES, "Blocks that failed the check, even after correction."},
+      {"corrected_blocks_total", METRIC_CORRECTED, "Blocks repaired by burst error correction."},
+      {"sync_losses_total", METRIC_SYNC_LOSSES, "Times block sync was lost."},
+      {"messages_total", METRIC_MESSAGES, "Messages decoded."},
+      {"decode_errors_total", METRIC_DECODE_ERRORS, "Messages whose groups disagree."},
+  };
+  std::string out;
+  describe(out, "uptime_seconds", "gauge", "Seconds since the decoder started counting.");
+  append(out, "rds_uptime_seconds %.3f\n", snapshot.uptime);
+  for (const Simple &metric : simple) {
+    describe(out, metric.name, "counter", metric.help);
+    append(out, "rds_%s %llu\n", metric.name, static_cast<unsigned long long>(snapshot.counters[metric.counter]));
+  }
+  describe(out, "blocks_by_offset_total", "counter", "Blocks by the offset word their syndrome matched.");
+  for (int i = 0; i < 5; i++) {
+    append(out, "rds_blocks_by_offset_total{offset=\"%s\"} %llu\n", offset_names[i],
+           static_cast<unsigned long long>(snapshot.counters[METRIC_OFFSET_A + i]));
+  }
+  describe(out, "groups_total", "counter", "Groups received by group type.");
+  for (uint8_t code = 0; code < group_type_codes; code++) {
+    if (!snapshot.groups[code]) continue;
+    char name[4];
+    group_name(code, name);
+    append(out, "rds_groups_total{type=\"%s\"} %llu\n", name, static_cast<unsigned long long>(snapshot.groups[code]));
+  }
+  describe(out, "unique_pis", "gauge", "Distinct PI codes received.");
+  append(out, "rds_unique_pis %llu\n", static_cast<unsigned long long>(snapshot.unique_pis));
+  describe(out, "stage_seconds_total", "counter", "Time spent per decoder stage, exclusive of nested stages.");
+  for (int i = 0; i < metric_stage_count; i++) append(out, "rds_stage_seconds_total{stage=\"%s\"} %.6f\n", stage_names[i], snapshot.stage_seconds[i]);
+  describe(out, "stage_calls_total", "counter", "Timed sections per decoder stage.");
+  for (int i = 0; i < metric_stage_count; i++) {
+    append(out, "rds_stage_calls_total{stage=\"%s\"} %llu\n", stage_names[i], static_cast<unsigned long long>(snapshot.stage_calls[i]));
+  }
+  return out;
+}
+
+bool write_metrics(const std::string &path, MetricFormat format) {
+  MetricSnapshot snapshot = collect_metrics();
+  std::string text = format == METRICS_JSON ? format_metrics_json(snapshot) : format_metrics_prometheus(snapshot);
+  std::string temporary = path + ".tmp";
+  FILE *file = std::fopen(temporary.c_str(), "w");
+  if (!file) return false;
+  bool ok = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+  ok = std::fclose(file) == 0 && ok;
+  return ok && std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+int parse_metric_format(const std::string &name, MetricFormat &format) {
+  if (name == "json") {
+    format = METRICS_JSON;
+  } else if (name == "prometheus") {
+    format = METRICS_PROMETHEUS;
+  } else {
+    return -1;
+  }
+  return 0;
+}
+
+MetricsExporter::MetricsExporter(const std::string &path, MetricFormat format, unsigned interval)
+    : path(path), format(format), interval(std::chrono::seconds(interval)), next(std::chrono::steady_clock::now() + this->interval) {
+  thread_metrics();
+}
+
+void MetricsExporter::poll() {
+  if (interval == std::chrono::steady_clock::duration::zero()) return;
+  auto now = std::chrono::steady_clock::now();
+  if (now < next) return;
+  next = now + interval;
+  write();
+}
+
+bool MetricsExporter::write() { return write_metrics(path, format); }
@@ -0,0 +1,216 @@
+/**
+ * @file       rds_metrics.hpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Runtime counters and stage timings of the decoder
+ *
+ * @date      17 October  2026 \n
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "common.hpp"
+
+/* Counters of the decode path */
+enum MetricCounter {
+  METRIC_BLOCKS,         /**< Blocks checked against their offset word */
+  METRIC_OFFSET_A,       /**< Blocks with offset A, followed by B, C, C' and D */
+  METRIC_OFFSET_B,       /**< Blocks with offset B */
+  METRIC_OFFSET_C,       /**< Blocks with offset C */
+  METRIC_OFFSET_CP,      /**< Blocks with offset C' */
+  METRIC_OFFSET_D,       /**< Blocks with offset D */
+  METRIC_CRC_FAILURES,   /**< Blocks that failed the check, even after correction */
+  METRIC_CORRECTED,      /**< Blocks repaired by burst error correction */
+  METRIC_SYNC_LOSSES,    /**< Times the synchronizer lost block sync */
+  METRIC_MESSAGES,       /**< Messages decoded */
+  METRIC_DECODE_ERRORS,  /**< Messages whose groups disagree */
+  metric_counter_count
+};
+
+/* Stages of the decoder, timed exclusive of the stages they call */
+enum MetricStage {
+  STAGE_READ,        /**< Reading the input */
+  STAGE_PARSE,       /**< Converting a -b argument into blocks */
+  STAGE_DEMODULATE,  /**< Recovering bits from a signal */
+  STAGE_SYNCHRONIZE, /**< Finding and checking blocks in a bitstream */
+  STAGE_DECODE,      /**< Sorting groups and decoding and printing messages */
+  metric_stage_count
+};
+
+/* Output of write_metrics() */
+enum MetricFormat {
+  METRICS_JSON,      /**< One JSON object */
+  METRICS_PROMETHEUS /**< Prometheus text exposition format */
+};
+
+/**
+ * Counters of one thread, on cache lines of their own so that threads never
+ * write to the same line. Only the owning thread writes them, with plain
+ * relaxed loads and stores instead of atomic read-modify-write, which cost
+ * as much as ordinary increments; other threads may read them at any time.
+ */
+struct alignas(64) MetricShard {
+  std::atomic<uint64_t> counters[metric_counter_count]; /**< Values of MetricCounter */
+  std::atomic<uint64_t> groups[group_type_codes];       /**< Groups received per group type code */
+  std::atomic<uint64_t> stage_ns[metric_stage_count];   /**< Nanoseconds spent per stage */
+  std::atomic<uint64_t> stage_calls[metric_stage_count]; /**< Timed sections per stage */
+  std::atomic<uint64_t> pi_seen[65536 / 64];             /**< Bitmap of received PI codes */
+};
+
+/** Shard of the calling thread, created on first use. */
+extern thread_local MetricShard *metric_shard;
+
+/**
+ * Creates and registers the shard of the calling thread.
+ * @return The shard, kept until the program ends.
+ */
+MetricShard *register_metric_shard();
+
+/** Returns the shard of the calling thread. */
+inline MetricShard &thread_metrics() { return metric_shard ? *metric_shard : *register_metric_shard(); }
+
+/**
+ * Adds to a counter of the calling thread.
+ * @param value The counter.
+ * @param count Amount to add.
+ */
+inline void metric_add(std::atomic<uint64_t> &value, uint64_t count = 1) {
+  value.store(value.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+}
+
+/**
+ * Counts an event of the decode path.
+ * @param counter The counter.
+ * @param count Amount to add.
+ */
+inline void count_metric(MetricCounter counter, uint64_t count = 1) { metric_add(thread_metrics().counters[counter], count); }
+
+/**
+ * Counts a checked block by the offset word its syndrome matched.
+ * @param offset The offset, OFFSET_INVALID counts only the block.
+ */
+inline void count_block(BlockOffset offset) {
+  MetricShard &shard = thread_metrics();
+  metric_add(shard.counters[METRIC_BLOCKS]);
+  if (offset != OFFSET_INVALID) metric_add(shard.counters[METRIC_OFFSET_A + offset]);
+}
+
+/**
+ * Counts a received group by its type and PI code.
+ * @param group The group in A, B, C, D order.
+ */
+void count_group(const uint32_t *group);
+
+/**
+ * Times a section of the decoder from construction to destruction. Timers
+ * nest: the time of an inner stage is left out of the outer one, so the
+ * stages add up to the total.
+ */
+class StageTimer {
+public:
+  /**
+   * Starts timing.
+   * @param stage The stage the section belongs to.
+   */
+  explicit StageTimer(MetricStage stage);
+
+  /** Stops timing and adds the time to the stage. */
+  ~StageTimer();
+
+  StageTimer(const StageTimer &) = delete;
+  StageTimer &operator=(const StageTimer &) = delete;
+
+private:
+  MetricStage stage;                             /**< The stage */
+  std::chrono::steady_clock::time_point start;   /**< Start of the section */
+  uint64_t nested_ns;                            /**< Time of the inner sections */
+  StageTimer *outer;                             /**< Section this one runs in, if any */
+};
+
+/** Sum of the counters of every thread. */
+struct MetricSnapshot {
+  double uptime;                                /**< Seconds since the first shard was created */
+  uint64_t counters[metric_counter_count];      /**< Values of MetricCounter */
+  uint64_t groups[group_type_codes];            /**< Groups per group type code */
+  double stage_seconds[metric_stage_count];     /**< Time per stage */
+  uint64_t stage_calls[metric_stage_count];     /**< Timed sections per stage */
+  uint64_t unique_pis;                          /**< Distinct PI codes received */
+};
+
+/**
+ * Adds up the shards of all threads.
+ * @return The totals.
+ */
+MetricSnapshot collect_metrics();
+
+/**
+ * Formats totals as JSON.
+ * @param snapshot The totals.
+ * @return One JSON object ending with a newline.
+ */
+std::string format_metrics_json(const MetricSnapshot &snapshot);
+
+/**
+ * Formats totals in the Prometheus text exposition format, names prefixed
+ * with rds_.
+ * @param snapshot The totals.
+ * @return The samples with their HELP and TYPE lines.
+ */
+std::string format_metrics_prometheus(const MetricSnapshot &snapshot);
+
+/**
+ * Writes the current totals to a file. The file is written under a
+ * temporary name and renamed, so a reader never sees half of it.
+ * @param path The file.
+ * @param format The format.
+ * @return false if the file cannot be written.
+ */
+bool write_metrics(const std::string &path, MetricFormat format);
+
+/**
+ * Parses the name of a metrics format.
+ * @param name "json" or "prometheus".
+ * @param format Output.
+ * @return 0 on success, -1 on an unknown name
+ */
+int parse_metric_format(const std::string &name, MetricFormat &format);
+
+/**
+ * Writes the metrics to a file at the end of a run and, if an interval is
+ * set, whenever poll() is called after the interval has passed.
+ */
+class MetricsExporter {
+public:
+  /**
+   * Constructor for MetricsExporter.
+   * @param path The file.
+   * @param format The format.
+   * @param interval Seconds between writes while running, 0 for none.
+   */
+  MetricsExporter(const std::string &path, MetricFormat format, unsigned interval);
+
+  /** Writes the metrics if the interval has passed since the last write. */
+  void poll();
+
+  /**
+   * Writes the metrics.
+   * @return false if the file cannot be written.
+   */
+  bool write();
+
+private:
+  std::string path;                                 /**< The file */
+  MetricFormat format;                              /**< The format */
+  std::chrono::steady_clock::duration interval;     /**< Time between writes, zero for none */
+  std::chrono::steady_clock::time_point next;       /**< Time of the next write */
+};
@@ -0,0 +1,167 @@
+/**
+ * @file       rds_modulator.cpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Synthesis of the 57 kHz RDS subcarrier from the bitstream
+ *
+ * @date      17 October  2026 \n
+ */
+
+#include "rds_modulator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "common.hpp"
+
+const double pi = 3.14159265358979323846;
+
+/**
+ * Stores a little-endian integer.
+ * @param out Output, bytes bytes.
+ * @param value The value.
+ * @param bytes Number of bytes.
+ */
+static void put_le(char *out, uint32_t value, unsigned bytes) {
+  for (unsigned i = 0; i < bytes; i++) out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+void wav_header(char *header, unsigned sample_rate, uint32_t data_bytes) {
+  std::memcpy(header, "RIFF", 4);
+  put_le(header + 4, data_bytes == 0xFFFFFFFF ? data_bytes : data_bytes + 36, 4);
+  std::memcpy(header + 8, "WAVEfmt ", 8);
+  put_le(header + 16, 16, 4);              // size of the fmt chunk
+  put_le(header + 20, 1, 2);               // integer PCM
+  put_le(header + 22, 1, 2);               // mono
+  put_le(header + 24, sample_rate, 4);
+  put_le(header + 28, sample_rate * 2, 4); // bytes per second
+  put_le(header + 32, 2, 2);               // bytes per sample
+  put_le(header + 34, 16, 2);              // bits per sample
+  std::memcpy(header + 36, "data", 4);
+  put_le(header + 40, data_bytes, 4);
+}
+
+/**
+ * Impulse response of the data filter H(f) = cos(pi f Td / 4) for
+ * 0 <= f <= 2 / Td, the spectrum shaping of the standard, unnormalized.
+ * @param t Time in seconds.
+ */
+static double shaping_response(double t) {
+  const double a = pi / bit_rate / 4;
+  const double f = 2 * bit_rate;
+  double b = 2 * pi * t;
+  auto term = [f](double x) { return std::fabs(x) < 1e-12 ? f : std::sin(x * f) / x; };
+  return term(a - b) + term(a + b);
+}
+
+double biphase_symbol(double t) {
+  const double quarter = 1 / bit_rate / 4;
+  return shaping_response(t + quarter) - shaping_response(t - quarter);
+}
+
+Modulator::Modulator(unsigned sample_rate, float level)
+    : sample_rate(sample_rate), radius(0), symbol_length(0), symbols(), carrier_period(0), carrier(), carrier_phase(0), baseband(),
+      baseband_start(0), bit_index(0), previous(0), output() {
+  double samples_per_bit = sample_rate / bit_rate;
+  // symbols are cut two bit periods from their center
+  radius = static_cast<size_t>(std::ceil(2 * samples_per_bit));
+  symbol_length = 2 * radius + 1;
+  symbols.resize(phases * symbol_length);
+  for (unsigned p = 0; p < phases; p++) {
+    for (size_t j = 0; j < symbol_length; j++) {
+      double offset = static_cast<double>(j) - static_cast<double>(radius) - static_cast<double>(p) / phases;
+      symbols[p * symbol_length + j] = static_cast<float>(biphase_symbol(offset / sample_rate));
+    }
+  }
+
+  // worst case of the overlapping symbols decides the scale
+  double peak = 0;
+  for (unsigned m = 0; m < phases; m++) {
+    double sum = 0;
+    for (int k = -2; k <= 2; k++) sum += std::fabs(biphase_symbol((m / static_cast<double>(phases) + k) / bit_rate));
+    peak = std::max(peak, sum);
+  }
+  double scale = level * 32767 / peak;
+
+  output.resize(33 * (static_cast<size_t>(samples_per_bit) + 2) + symbol_length);
+  unsigned a = sample_rate;
+  unsigned b = static_cast<unsigned>(subcarrier);
+  while (b) {
+    unsigned r = a % b;
+    a = b;
+    b = r;
+  }
+  carrier_period = sample_rate / a;
+  // room to run over the period keeps the mixing loop free of wrap-around
+  carrier.resize(carrier_period + output.size());
+  for (size_t i = 0; i < carrier.size(); i++) {
+    double phase = 2 * pi * static_cast<double>(i % carrier_period) * subcarrier / sample_rate;
+    carrier[i] = static_cast<float>(std::cos(phase) * scale);
+  }
+}
+
+size_t Modulator::emit(size_t count) {
+  const float *in = baseband.data();
+  const float *mix = carrier.data() + carrier_phase;
+  int16_t *out = output.data();
+  for (size_t i = 0; i < count; i++) {
+    float value = in[i] * mix[i];
+    out[i] = static_cast<int16_t>(value < 0 ? value - 0.5f : value + 0.5f);
+  }
+  carrier_phase = (carrier_phase + count) % carrier_period;
+  baseband.erase(baseband.begin(), baseband.begin() + static_cast<std::ptrdiff_t>(count));
+  baseband_start += count;
+  return count;
+}
+
+size_t Modulator::modulate(uint32_t bits, unsigned count) {
+  uint64_t start = 0;
+  for (unsigned i = count; i-- > 0;) {
+    // the center of the bit, (n + 1/2) bit periods, in 1/2375 samples
+    uint64_t center = (2 * bit_index + 1) * sample_rate;
+    start = center / 2375;
+    unsigned phase = static_cast<unsigned>(((center % 2375) * phases + 1187) / 2375);
+    if (phase == phases) {
+      start++;
+      phase = 0;
+    }
+
+    unsigned bit = ((bits >> i) & 1) ^ previous;
+    previous = bit;
+    float sign = bit ? 1.0f : -1.0f;
+
+    size_t offset = static_cast<size_t>(start - baseband_start);
+    if (baseband.size() < offset + symbol_length) baseband.resize(offset + symbol_length, 0.0f);
+    float *out = baseband.data() + offset;
+    const float *symbol = symbols.data() + phase * symbol_length;
+    for (size_t j = 0; j < symbol_length; j++) out[j] += sign * symbol[j];
+    bit_index++;
+  }
+
+  // symbols of later bits start at or after the start of the next one
+  uint64_t next = (2 * bit_index + 1) * sample_rate / 2375;
+  return emit(static_cast<size_t>(std::min<uint64_t>(next, baseband_start + baseband.size()) - baseband_start));
+}
+
+size_t Modulator::finish() { return emit(baseband.size()); }
+
+FmModulator::FmModulator(unsigned sample_rate, double deviation)
+    : step(deviation / sample_rate * 4294967296.0 / 32768), phase(0), sine((1u << table_bits) + (1u << table_bits) / 4) {
+  for (size_t i = 0; i < sine.size(); i++) sine[i] = static_cast<float>(std::sin(2 * pi * static_cast<double>(i) / (1u << table_bits)));
+}
+
+void FmModulator::modulate(const int16_t *samples, size_t count, float *iq) {
+  const size_t quarter = (1u << table_bits) / 4;
+  for (size_t i = 0; i < count; i++) {
+    // a negative increment wraps around like the phase
+    phase += static_cast<uint32_t>(static_cast<int64_t>(samples[i] * step));
+    uint32_t index = phase >> (32 - table_bits);
+    iq[2 * i] = sine[index + quarter];
+    iq[2 * i + 1] = sine[index];
+  }
+}
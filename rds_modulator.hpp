@@ -0,0 +1,142 @@
+/**
+ * @file       rds_modulator.hpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Synthesis of the 57 kHz RDS subcarrier from the bitstream
+ *
+ * @date      17 October  2026 \n
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const unsigned default_sample_rate = 228000; /**< Default PCM rate, 4 samples per subcarrier period */
+const unsigned min_sample_rate = 128000;     /**< Lowest rate that carries the subcarrier and its sidebands */
+const unsigned max_sample_rate = 3200000;    /**< Highest supported rate, that of the fastest SDR captures */
+const size_t wav_header_size = 44;           /**< Bytes of a canonical PCM WAV header */
+const double fm_deviation = 75000;           /**< Frequency deviation of a full-scale multiplex signal in Hz */
+const float fm_rds_level = 0.05f;            /**< Peak subcarrier level in an FM signal, 3.75 kHz of deviation */
+
+/**
+ * Fills in the header of a mono 16-bit PCM WAV file.
+ * @param header Output, wav_header_size bytes.
+ * @param sample_rate Samples per second.
+ * @param data_bytes Bytes of samples, 0xFFFFFFFF if unknown (streaming).
+ */
+void wav_header(char *header, unsigned sample_rate, uint32_t data_bytes);
+
+/**
+ * Biphase symbol of a 1 bit: a positive impulse half a bit period before
+ * a negative one, both shaped by the cos(pi f Td / 4) data filter.
+ * @param t Time from the center of the bit in seconds.
+ * @return The unnormalized symbol waveform.
+ */
+double biphase_symbol(double t);
+
+/**
+ * Turns RDS bits into the modulated subcarrier as 16-bit PCM, following
+ * the coding chain of the standard: differential encoding, biphase symbols
+ * shaped by the cos(pi f Td / 4) data filter, and amplitude modulation of
+ * a suppressed 57 kHz carrier.
+ *
+ * The shaped symbol lasts four bit periods, so the symbols of neighbouring
+ * bits overlap and are added up in an accumulator. Symbol waveforms are
+ * computed once for 64 sub-sample positions, as the bit period is rarely a
+ * whole number of samples, and the carrier once for the shortest period of
+ * samples after which it repeats. Per bit only the symbol is added and the
+ * finished samples are mixed with the carrier, in plain loops over
+ * contiguous arrays that the compiler vectorizes.
+ */
+class Modulator {
+public:
+  /**
+   * Constructor for Modulator.
+   * @param sample_rate Samples per second, min_sample_rate to max_sample_rate.
+   * @param level Peak amplitude as a fraction of full scale.
+   */
+  explicit Modulator(unsigned sample_rate, float level = 0.9f);
+
+  /**
+   * Modulates bits, most significant bit first.
+   * @param bits The bits, right aligned.
+   * @param count Number of bits, at most 32.
+   * @return Number of samples finished, available through samples().
+   */
+  size_t modulate(uint32_t bits, unsigned count);
+
+  /**
+   * Finishes the signal after the last bit, letting its symbol decay.
+   * @return Number of samples finished, available through samples().
+   */
+  size_t finish();
+
+  /** Returns the samples finished by the last call to modulate() or finish(). */
+  const int16_t *samples() const { return output.data(); }
+
+  /** Returns the highest number of samples a call to modulate() finishes. */
+  size_t max_samples() const { return output.size(); }
+
+  /** Returns the sample rate. */
+  unsigned get_sample_rate() const { return sample_rate; }
+
+private:
+  /**
+   * Mixes finished baseband samples with the carrier into the output.
+   * @param count Number of samples from the start of the accumulator.
+   * @return count
+   */
+  size_t emit(size_t count);
+
+  static const unsigned phases = 64; /**< Sub-sample positions of the symbol tables */
+
+  unsigned sample_rate;          /**< Samples per second */
+  size_t radius;                 /**< Samples of a symbol on each side of its center */
+  size_t symbol_length;          /**< Samples of a symbol table, 2 * radius + 1 */
+  std::vector<float> symbols;    /**< Symbol tables, phases of symbol_length samples */
+  size_t carrier_period;         /**< Samples after which the carrier repeats */
+  std::vector<float> carrier;    /**< Carrier samples, scaled, a period plus room to run over */
+  size_t carrier_phase;          /**< Carrier index of the first accumulator sample */
+  std::vector<float> baseband;   /**< Accumulated symbols not yet finished */
+  uint64_t baseband_start;       /**< Sample index of baseband[0] */
+  uint64_t bit_index;            /**< Index of the next bit */
+  unsigned previous;             /**< Last differentially encoded bit */
+  std::vector<int16_t> output;   /**< Finished samples */
+};
+
+/**
+ * Frequency modulates a multiplex signal onto a carrier at 0 Hz, giving
+ * the complex baseband that an SDR receiver tuned to the station records.
+ * The phase is a 32-bit accumulator that wraps around by itself, and the
+ * carrier is read from a sine table, so no trigonometry runs per sample.
+ */
+class FmModulator {
+public:
+  /**
+   * Constructor for FmModulator.
+   * @param sample_rate Samples per second.
+   * @param deviation Frequency deviation of a full-scale sample in Hz.
+   */
+  explicit FmModulator(unsigned sample_rate, double deviation = fm_deviation);
+
+  /**
+   * Modulates the next samples.
+   * @param samples The multiplex signal, 16-bit PCM.
+   * @param count Number of samples.
+   * @param iq Output, count pairs of I and Q with a magnitude of 1.
+   */
+  void modulate(const int16_t *samples, size_t count, float *iq);
+
+private:
+  static const unsigned table_bits = 12; /**< Bits of the phase that index the sine table */
+
+  double step;             /**< Phase increment per unit of a sample, 2^32 per turn */
+  uint32_t phase;          /**< Phase of the carrier, 2^32 per turn */
+  std::vector<float> sine; /**< A turn of the sine and the quarter after it, for the cosine */
+};
@@ -0,0 +1,166 @@
+/**
+ * @file       rds_monitor.cpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Block error rate of a live stream over rolling windows
+ *
+ * @date      17 October  2026 \n
+ */
+
+#include "rds_monitor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "common.hpp"
+
+/** Names of the windows in the status and alert lines. */
+static const char *window_names[] = {"100g", "1m", "10m"};
+
+/** Number of set bits of a block mask, without relying on a popcount instruction. */
+static const uint8_t mask_blocks[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+GroupWindow::GroupWindow() : slots(), next(0), count(0), errors(0), corrected(0) {}
+
+void GroupWindow::push(uint8_t valid, uint8_t corrected) {
+  // slots not yet used are zero, so the oldest one can always be subtracted
+  uint8_t old = slots[next];
+  uint8_t bad = static_cast<uint8_t>(4 - mask_blocks[valid & 0xF]);
+  uint8_t fixed = mask_blocks[corrected & 0xF];
+  slots[next] = static_cast<uint8_t>(bad | fixed << 4);
+  errors += bad - (old & 0xFu);
+  this->corrected += fixed - (old >> 4);
+  count += count < monitor_groups;
+  next = next + 1 == monitor_groups ? 0 : next + 1;
+}
+
+TimeWindow::TimeWindow(uint64_t span)
+    : width(std::max<uint64_t>(span / monitor_buckets, 1)), current(0), end(width), buckets(), groups(0), errors(0), corrected(0) {}
+
+void TimeWindow::slide(uint64_t time) {
+  uint64_t index = time / width;
+  // after a whole window of silence every bucket is cleared once
+  uint64_t steps = std::min<uint64_t>(index - current, monitor_buckets);
+  for (uint64_t i = 1; i <= steps; i++) {
+    Bucket &bucket = buckets[(index - steps + i) % monitor_buckets];
+    groups -= bucket.groups;
+    errors -= bucket.errors;
+    corrected -= bucket.corrected;
+    bucket = Bucket{};
+  }
+  current = index;
+  end = (index + 1) * width;
+}
+
+void TimeWindow::push(unsigned errors, unsigned corrected) {
+  Bucket &bucket = buckets[current % monitor_buckets];
+  bucket.groups++;
+  bucket.errors += errors;
+  bucket.corrected += corrected;
+  groups++;
+  this->errors += errors;
+  this->corrected += corrected;
+}
+
+QualityMonitor::QualityMonitor(unsigned interval, double threshold, std::ostream &status, std::ostream &alerts)
+    : interval(interval), threshold(threshold), status(status), alerts(alerts), time(0),
+      next_status(interval ? static_cast<uint64_t>(std::ceil(interval * bit_rate)) : UINT64_MAX), lost_bits(0), synced(false),
+      last_groups(), last_minute(static_cast<uint64_t>(60 * bit_rate)), last_ten(static_cast<uint64_t>(600 * bit_rate)), alerting() {}
+
+void QualityMonitor::push_group(uint8_t valid, uint8_t corrected) {
+  // bits before the acquisition are part of this group
+  lost_bits = 0;
+  synced = true;
+  unsigned errors = 4u - mask_blocks[valid & 0xF];
+  unsigned fixed = mask_blocks[corrected & 0xF];
+  last_groups.push(valid, corrected);
+  last_minute.advance(time);
+  last_minute.push(errors, fixed);
+  last_ten.advance(time);
+  last_ten.push(errors, fixed);
+  if (threshold >= 0) check_alerts();
+}
+
+void QualityMonitor::update() {
+  if (lost_bits >= 104) {
+    synced = false;
+    last_minute.advance(time);
+    last_ten.advance(time);
+    for (; lost_bits >= 104; lost_bits -= 104) {
+      last_groups.push(0, 0);
+      last_minute.push(4, 0);
+      last_ten.push(4, 0);
+    }
+    if (threshold >= 0) check_alerts();
+  }
+  if (time >= next_status) {
+    print_status();
+    next_status = static_cast<uint64_t>(std::ceil((std::floor(time / (interval * bit_rate)) + 1) * interval * bit_rate));
+  }
+}
+
+/**
+ * Formats the current stream time.
+ * @param time Bits received since the start.
+ * @param out Output, at least 16 characters.
+ */
+static void format_time(uint64_t time, char *out) {
+  uint64_t seconds = static_cast<uint64_t>(time / bit_rate);
+  std::snprintf(out, 16, "%02u:%02u:%02u", static_cast<unsigned>(seconds / 3600), static_cast<unsigned>(seconds / 60 % 60),
+                static_cast<unsigned>(seconds % 60));
+}
+
+/**
+ * Returns a block error rate in percent.
+ * @param errors Bad blocks.
+ * @param groups Groups, four blocks each.
+ */
+static double error_rate(uint64_t errors, uint64_t groups) { return groups ? 100.0 * static_cast<double>(errors) / static_cast<double>(groups * 4) : 0; }
+
+void QualityMonitor::print_status() {
+  last_minute.advance(time);
+  last_ten.advance(time);
+  uint64_t groups[] = {last_groups.get_groups(), last_minute.get_groups(), last_ten.get_groups()};
+  uint64_t errors[] = {last_groups.get_errors(), last_minute.get_errors(), last_ten.get_errors()};
+  char time_text[16];
+  format_time(time, time_text);
+  // formatted into one buffer, the line costs no allocation
+  char line[192];
+  int length = std::snprintf(line, sizeof(line), "[%s] BLER", time_text);
+  for (int i = 0; i < 3; i++) {
+    if (groups[i]) {
+      length += std::snprintf(line + length, sizeof(line) - static_cast<size_t>(length), " %s %.2f%%", window_names[i], error_rate(errors[i], groups[i]));
+    } else {
+      length += std::snprintf(line + length, sizeof(line) - static_cast<size_t>(length), " %s -", window_names[i]);
+    }
+  }
+  std::snprintf(line + length, sizeof(line) - static_cast<size_t>(length), " corrected %.2f%% groups %u sync %s",
+                error_rate(last_minute.get_corrected(), last_minute.get_groups()), last_minute.get_groups(), synced ? "locked" : "lost");
+  status << line << std::endl;
+}
+
+void QualityMonitor::check_alerts() {
+  uint64_t groups[] = {last_groups.get_groups(), last_minute.get_groups(), last_ten.get_groups()};
+  uint64_t errors[] = {last_groups.get_errors(), last_minute.get_errors(), last_ten.get_errors()};
+  for (int i = 0; i < 3; i++) {
+    if (groups[i] < monitor_min_groups) continue;
+    // compared without dividing, this runs for every group
+    double percent = 100.0 * static_cast<double>(errors[i]);
+    double blocks = 4.0 * static_cast<double>(groups[i]);
+    if (alerting[i] ? percent >= threshold * monitor_clear_ratio * blocks : percent <= threshold * blocks) continue;
+    alerting[i] = !alerting[i];
+    double rate = error_rate(errors[i], groups[i]);
+    char time_text[16];
+    char line[160];
+    format_time(time, time_text);
+    std::snprintf(line, sizeof(line), "[%s] %s BLER %s %.2f%% %s %.2f%%", time_text, alerting[i] ? "ALERT" : "CLEAR", window_names[i], rate,
+                  alerting[i] ? "above" : "below",
+                  alerting[i] ? threshold : threshold * monitor_clear_ratio);
+    alerts << line << std::endl;
+  }
+}
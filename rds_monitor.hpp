@@ -0,0 +1,187 @@
+/**
+ * @file       rds_monitor.hpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Block error rate of a live stream over rolling windows
+ *
+ * @date      17 October  2026 \n
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+const unsigned monitor_groups = 100;      /**< Groups in the shortest window */
+const unsigned monitor_buckets = 60;      /**< Buckets of each time window */
+const unsigned monitor_min_groups = 100;  /**< Groups a window needs before it can raise an alert */
+const double monitor_clear_ratio = 0.8;   /**< Share of the threshold a window must fall below to clear its alert */
+
+/**
+ * Block error rate over the last monitor_groups groups. Every slot of the
+ * ring holds the bad and repaired block counts of one group, so an update
+ * replaces one byte and adjusts the running sums by the difference.
+ */
+class GroupWindow {
+public:
+  GroupWindow();
+
+  /**
+   * Adds a group, replacing the oldest one once the window is full.
+   * @param valid Bitmask of the blocks that passed the check.
+   * @param corrected Bitmask of the blocks that were repaired.
+   */
+  void push(uint8_t valid, uint8_t corrected);
+
+  /** Returns the number of groups in the window. */
+  unsigned get_groups() const { return count; }
+
+  /** Returns the number of bad blocks in the window. */
+  unsigned get_errors() const { return errors; }
+
+  /** Returns the number of repaired blocks in the window. */
+  unsigned get_corrected() const { return corrected; }
+
+private:
+  uint8_t slots[monitor_groups]; /**< Bad blocks in the low and repaired blocks in the high nibble */
+  unsigned next;                 /**< Slot of the next group */
+  unsigned count;                /**< Groups in the window */
+  unsigned errors;               /**< Bad blocks in the window */
+  unsigned corrected;            /**< Repaired blocks in the window */
+};
+
+/**
+ * Block error rate over a span of stream time, split into monitor_buckets
+ * buckets. Groups are added to the bucket of the current time; when time
+ * moves into a new bucket, the bucket it replaces is subtracted from the
+ * running sums and cleared.
+ */
+class TimeWindow {
+public:
+  /**
+   * Constructor for TimeWindow.
+   * @param span Length of the window in bits of stream time.
+   */
+  explicit TimeWindow(uint64_t span);
+
+  /**
+   * Moves the window to the given time.
+   * @param time Bits received since the start of the stream.
+   */
+  void advance(uint64_t time) {
+    if (time >= end) slide(time);
+  }
+
+  /**
+   * Adds a group at the current time.
+   * @param errors Bad blocks of the group.
+   * @param corrected Repaired blocks of the group.
+   */
+  void push(unsigned errors, unsigned corrected);
+
+  /** Returns the number of groups in the window. */
+  uint32_t get_groups() const { return groups; }
+
+  /** Returns the number of bad blocks in the window. */
+  uint32_t get_errors() const { return errors; }
+
+  /** Returns the number of repaired blocks in the window. */
+  uint32_t get_corrected() const { return corrected; }
+
+private:
+  /**
+   * Moves the window into a later bucket, clearing the buckets it replaces.
+   * @param time Bits received since the start of the stream.
+   */
+  void slide(uint64_t time);
+
+  /** Groups and blocks counted during one bucket of time. */
+  struct Bucket {
+    uint32_t groups;    /**< Groups */
+    uint32_t errors;    /**< Bad blocks */
+    uint32_t corrected; /**< Repaired blocks */
+  };
+
+  uint64_t width;                   /**< Bits of stream time per bucket */
+  uint64_t current;                 /**< Index of the bucket of the current time */
+  uint64_t end;                     /**< Time at which the current bucket ends */
+  Bucket buckets[monitor_buckets];  /**< Ring of buckets, current % monitor_buckets is the newest */
+  uint32_t groups;                  /**< Groups in the window */
+  uint32_t errors;                  /**< Bad blocks in the window */
+  uint32_t corrected;               /**< Repaired blocks in the window */
+};
+
+/**
+ * Watches the reception quality of a stream. The block error rate is kept
+ * over the last monitor_groups groups, the last minute and the last ten
+ * minutes; time is counted in received bits at the RDS bit rate, so a
+ * capture read from a file gives the same results as the live signal.
+ * Groups lost while out of sync count as four bad blocks each. A status
+ * line is printed at a fixed interval, and an alert line whenever a window
+ * rises above the threshold; the alert clears once the window falls below
+ * monitor_clear_ratio of it, so a rate hovering at the threshold does not
+ * flood the log.
+ */
+class QualityMonitor {
+public:
+  /**
+   * Constructor for QualityMonitor.
+   * @param interval Seconds of stream time between status lines, 0 for none.
+   * @param threshold Block error rate in percent that raises an alert,
+   *        negative for none.
+   * @param status Receives the status lines.
+   * @param alerts Receives the alert lines.
+   */
+  QualityMonitor(unsigned interval, double threshold, std::ostream &status, std::ostream &alerts);
+
+  /**
+   * Counts received bits.
+   * @param bits Number of bits.
+   * @param synced Whether the synchronizer was locked while they arrived.
+   */
+  void advance(unsigned bits, bool synced) {
+    time += bits;
+    if (!synced) lost_bits += bits;
+    if (time >= next_status || lost_bits >= 104) update();
+  }
+
+  /**
+   * Counts a group completed by the synchronizer.
+   * @param valid Bitmask of the blocks that passed the check.
+   * @param corrected Bitmask of the blocks that were repaired.
+   */
+  void push_group(uint8_t valid, uint8_t corrected);
+
+  /** Prints a last status line at the end of the stream, if status lines are enabled. */
+  void finish() {
+    if (interval) print_status();
+  }
+
+  /** Prints a status line for the current time. */
+  void print_status();
+
+private:
+  /** Counts groups lost out of sync and prints the lines that are due. */
+  void update();
+
+  /** Prints alert lines for the windows that rose above or fell back below the threshold. */
+  void check_alerts();
+
+  unsigned interval;    /**< Seconds between status lines, 0 for none */
+  double threshold;     /**< Alert threshold in percent, negative for none */
+  std::ostream &status; /**< Receives the status lines */
+  std::ostream &alerts; /**< Receives the alert lines */
+  uint64_t time;        /**< Bits received since the start */
+  uint64_t next_status; /**< Time of the next status line */
+  uint64_t lost_bits;   /**< Bits received out of sync and not yet counted as lost groups */
+  bool synced;          /**< Whether the last group arrived after the last lost one */
+  GroupWindow last_groups; /**< The last monitor_groups groups */
+  TimeWindow last_minute;  /**< The last minute */
+  TimeWindow last_ten;     /**< The last ten minutes */
+  bool alerting[3];        /**< Whether each window is above the threshold */
+};
@@ -0,0 +1,167 @@
+/**
+ * @file       rds_scheduler.cpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Group scheduler for continuous transmission of a station
+ *
+ * @date      17 October  2026 \n
+ */
+
+#include "rds_scheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "common.hpp"
+
+GroupScheduler::GroupScheduler() : sources(), total_weight(0), slot(0) {}
+
+size_t GroupScheduler::add_source(unsigned weight, uint64_t max_interval, unsigned segments) {
+  Source source{};
+  source.weight = weight;
+  source.max_interval = max_interval;
+  source.segments = std::max(segments, 1u);
+  // a source with a deadline goes out once right away
+  source.has_due = max_interval != 0;
+  sources.push_back(source);
+  total_weight += weight;
+  return sources.size() - 1;
+}
+
+void GroupScheduler::set_due(size_t source, uint64_t due_slot) {
+  sources[source].has_due = true;
+  sources[source].due = due_slot;
+}
+
+void GroupScheduler::set_segments(size_t source, unsigned segments) {
+  Source &s = sources[source];
+  s.segments = std::max(segments, 1u);
+  // a shorter message starts over from its first segment
+  if (s.segment >= s.segments) s.segment = 0;
+}
+
+unsigned GroupScheduler::send(size_t index) {
+  Source &source = sources[index];
+  SourceStats &stats = source.stats;
+  stats.groups++;
+  stats.max_gap = std::max(stats.max_gap, slot - (source.sent ? source.last_slot : 0));
+
+  unsigned segment = source.segment;
+  source.segment = (segment + 1) % source.segments;
+  if (source.segment == 0) {
+    // the last segment completes a rotation
+    uint64_t rotation = slot + 1 - source.rotation_end;
+    stats.rotations++;
+    stats.max_rotation = std::max(stats.max_rotation, rotation);
+    stats.total_rotation += rotation;
+    source.rotation_end = slot + 1;
+  }
+
+  source.sent = true;
+  source.last_slot = slot;
+  source.has_due = source.max_interval != 0;
+  source.due = slot + source.max_interval;
+  return segment;
+}
+
+size_t GroupScheduler::next(unsigned &segment) {
+  // the source due earliest goes first once its deadline is reached
+  size_t due = sources.size();
+  for (size_t i = 0; i < sources.size(); i++) {
+    if (sources[i].has_due && sources[i].due <= slot && (due == sources.size() || sources[i].due < sources[due].due)) due = i;
+  }
+
+  size_t picked = due;
+  if (picked == sources.size() && total_weight > 0) {
+    for (size_t i = 0; i < sources.size(); i++) {
+      sources[i].credit += sources[i].weight;
+      if (sources[i].weight && (picked == sources.size() || sources[i].credit > sources[picked].credit)) picked = i;
+    }
+    sources[picked].credit -= total_weight;
+  }
+  if (picked == sources.size()) {
+    // only deadline sources, send the next one early
+    picked = 0;
+    for (size_t i = 1; i < sources.size(); i++) {
+      if (sources[i].has_due && (!sources[picked].has_due || sources[i].due < sources[picked].due)) picked = i;
+    }
+  }
+
+  segment = send(picked);
+  slot++;
+  return picked;
+}
+
+Carousel::Carousel(const CarouselConfig &config)
+    : config(config), scheduler(), source_0A(-1), source_2A(-1), source_4A(-1), cache() {
+  if (config.weight_0A) {
+    cache.update_0a(config.ps);
+    source_0A = static_cast<int>(scheduler.add_source(config.weight_0A, 0, RDS_0A_BLOCKS / 4));
+  }
+  if (config.weight_2A) {
+    cache.update_2a(config.rt);
+    source_2A = static_cast<int>(scheduler.add_source(config.weight_2A, 0, cache.segments_2a()));
+  }
+  if (config.clock) {
+    // the first 4A goes out right away, later ones at the start of each minute
+    source_4A = static_cast<int>(scheduler.add_source(0, 0, 1));
+    scheduler.set_due(static_cast<size_t>(source_4A), 0);
+  }
+}
+
+void Carousel::update_0a(const rds_0a_config &ps) {
+  config.ps = ps;
+  cache.update_0a(ps);
+}
+
+void Carousel::update_2a(const rds_2a_config &rt) {
+  config.rt = rt;
+  cache.update_2a(rt);
+  if (source_2A >= 0) scheduler.set_segments(static_cast<size_t>(source_2A), cache.segments_2a());
+}
+
+int Carousel::get_source(uint8_t code) const {
+  if (code == group_type_code_0A) return source_0A;
+  if (code == group_type_code_2A) return source_2A;
+  if (code == group_type_code_4A) return source_4A;
+  return -1;
+}
+
+uint64_t Carousel::next_minute(uint64_t slot) const {
+  double elapsed = static_cast<double>(slot) / group_rate;
+  double minute = std::floor((static_cast<double>(config.start_time) + elapsed) / 60) + 1;
+  return static_cast<uint64_t>(std::ceil((minute * 60 - static_cast<double>(config.start_time)) * group_rate));
+}
+
+uint8_t Carousel::next_group(uint32_t *group) {
+  uint64_t slot = scheduler.get_slot();
+  unsigned segment;
+  int source = static_cast<int>(scheduler.next(segment));
+
+  if (source == source_0A) {
+    std::copy_n(cache.blocks_0a() + segment * 4, 4, group);
+    return group_type_code_0A;
+  }
+  if (source == source_2A) {
+    std::copy_n(cache.blocks_2a() + segment * 4, 4, group);
+    return group_type_code_2A;
+  }
+
+  // clock time of the slot, the seconds are not transmitted
+  time_t now = config.start_time + static_cast<time_t>(static_cast<double>(slot) / group_rate);
+  rds_4a_config clock{};
+  clock.pi = config.weight_0A ? config.ps.pi : config.rt.pi;
+  clock.pty = config.weight_0A ? config.ps.pty : config.rt.pty;
+  clock.tp = config.weight_0A ? config.ps.tp : config.rt.tp;
+  clock.mjd = static_cast<uint32_t>(now / 86400 + 40587);
+  clock.hour = static_cast<uint8_t>(now % 86400 / 3600);
+  clock.minute = static_cast<uint8_t>(now % 3600 / 60);
+  clock.local_offset = config.local_offset;
+  rds_encode_4a(&clock, group, RDS_4A_BLOCKS);
+  scheduler.set_due(static_cast<size_t>(source_4A), next_minute(slot));
+  return group_type_code_4A;
+}
@@ -0,0 +1,190 @@
+/**
+ * @file       rds_scheduler.hpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Group scheduler for continuous transmission of a station
+ *
+ * @date      17 October  2026 \n
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+#include "common.hpp"
+#include "rds.h"
+#include "rds_cache.hpp"
+
+const double group_rate = bit_rate / 104; /**< Groups per second, about 11.4 */
+
+/** Transmission statistics of one source. */
+struct SourceStats {
+  uint64_t groups;          /**< Number of groups sent */
+  uint64_t max_gap;         /**< Longest time between two groups, in slots */
+  uint64_t rotations;       /**< Number of completed rotations through all segments */
+  uint64_t max_rotation;    /**< Longest time between two completed rotations, in slots */
+  uint64_t total_rotation;  /**< Sum of the times between completed rotations, in slots */
+};
+
+/**
+ * Decides which source sends the group of every slot.
+ *
+ * Sources with a weight share the slots by smooth weighted round-robin:
+ * every slot each source gains its weight in credit, the source with the
+ * most credit is picked and pays the total weight back. A source may also
+ * have a deadline, the slot by which it has to be sent next; a due source
+ * is picked before any weighted one. Sources with weight 0 are only sent
+ * when due. The time a source needs to rotate through all of its segments
+ * is recorded, starting from slot 0.
+ */
+class GroupScheduler {
+public:
+  /** Constructor for GroupScheduler. */
+  GroupScheduler();
+
+  /**
+   * Adds a source.
+   * @param weight Share of the slots, 0 for deadline-only sources.
+   * @param max_interval Slots after which the source is due again, 0 for none.
+   * @param segments Number of segments the source rotates through.
+   * @return Index of the source.
+   */
+  size_t add_source(unsigned weight, uint64_t max_interval, unsigned segments);
+
+  /**
+   * Sets the slot by which a source has to be sent next, overriding its
+   * max_interval until it is sent.
+   * @param source Index of the source.
+   * @param slot The slot.
+   */
+  void set_due(size_t source, uint64_t slot);
+
+  /**
+   * Changes the number of segments a source rotates through.
+   * @param source Index of the source.
+   * @param segments Number of segments.
+   */
+  void set_segments(size_t source, unsigned segments);
+
+  /**
+   * Picks the source of the next slot.
+   * @param segment Output, segment the source sends in this slot.
+   * @return Index of the source.
+   */
+  size_t next(unsigned &segment);
+
+  /** Returns the number of slots scheduled so far. */
+  uint64_t get_slot() const { return slot; }
+
+  /**
+   * Returns the statistics of a source.
+   * @param source Index of the source.
+   */
+  const SourceStats &get_stats(size_t source) const { return sources[source].stats; }
+
+private:
+  /** State of one source. */
+  struct Source {
+    unsigned weight;       /**< Share of the slots */
+    uint64_t max_interval; /**< Slots after which the source is due again, 0 for none */
+    unsigned segments;     /**< Number of segments */
+    int64_t credit;        /**< Smooth weighted round-robin credit */
+    unsigned segment;      /**< Next segment to send */
+    bool has_due;          /**< Whether due is set */
+    uint64_t due;          /**< Slot by which the source has to be sent */
+    bool sent;             /**< Whether a group has been sent */
+    uint64_t last_slot;    /**< Slot of the last group sent */
+    uint64_t rotation_end; /**< Slot after the last completed rotation */
+    SourceStats stats;     /**< Transmission statistics */
+  };
+
+  /**
+   * Records that a source sends the current slot.
+   * @param index Index of the source.
+   * @return Segment the source sends.
+   */
+  unsigned send(size_t index);
+
+  std::vector<Source> sources; /**< Sources in order of addition */
+  int64_t total_weight;        /**< Sum of the weights */
+  uint64_t slot;               /**< Index of the next slot */
+};
+
+/** What a Carousel transmits and how often. */
+struct CarouselConfig {
+  rds_0a_config ps;        /**< PS message */
+  rds_2a_config rt;        /**< RT message */
+  unsigned weight_0A;      /**< Share of 0A groups, 0 to leave them out */
+  unsigned weight_2A;      /**< Share of 2A groups, 0 to leave them out */
+  bool clock;              /**< Send a 4A group at the start of every minute */
+  time_t start_time;       /**< UTC time of slot 0, for 4A */
+  int8_t local_offset;     /**< Local time offset in half hours, for 4A */
+};
+
+/**
+ * Generates an unbounded sequence of groups for one station, interleaving
+ * its PS (0A), RT (2A) and clock time (4A) messages as configured. The
+ * groups of the PS and RT messages are kept in a BlockCache, so a changed
+ * message only re-encodes the blocks that differ.
+ */
+class Carousel {
+public:
+  /**
+   * Constructor for Carousel.
+   * @param config What to transmit and how often.
+   */
+  explicit Carousel(const CarouselConfig &config);
+
+  /**
+   * Produces the group of the next slot.
+   * @param group Output, the four blocks in transmission order.
+   * @return Group Type + Version Code of the group.
+   */
+  uint8_t next_group(uint32_t *group);
+
+  /**
+   * Replaces the PS message from the next group on.
+   * @param ps The new message, with the PI of the station.
+   */
+  void update_0a(const rds_0a_config &ps);
+
+  /**
+   * Replaces the RT message from the next group on.
+   * @param rt The new message, with the PI of the station.
+   */
+  void update_2a(const rds_2a_config &rt);
+
+  /** Returns the number of PS and RT blocks encoded so far. */
+  uint64_t get_encoded() const { return cache.get_encoded(); }
+
+  /** Returns the scheduler, for statistics. */
+  const GroupScheduler &get_scheduler() const { return scheduler; }
+
+  /**
+   * Returns the scheduler source of a group type.
+   * @param code Group Type + Version Code.
+   * @return Index of the source, -1 if the type is not transmitted.
+   */
+  int get_source(uint8_t code) const;
+
+private:
+  /**
+   * Returns the first slot that starts a later minute than a given slot.
+   * @param slot The slot.
+   */
+  uint64_t next_minute(uint64_t slot) const;
+
+  CarouselConfig config;             /**< What to transmit */
+  GroupScheduler scheduler;          /**< Picks the group of every slot */
+  int source_0A;                     /**< Scheduler source of 0A, -1 if unused */
+  int source_2A;                     /**< Scheduler source of 2A, -1 if unused */
+  int source_4A;                     /**< Scheduler source of 4A, -1 if unused */
+  BlockCache cache;                  /**< Encoded PS and RT messages */
+};
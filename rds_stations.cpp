@@ -0,0 +1,221 @@
+/**
+ * @file       rds_stations.cpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Per-station state for captures that mix several transmitters
+ *
+ * @date      17 October  2026 \n
+ */
+
+#include "rds_stations.hpp"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+/* Highest AF code that names a frequency, 87.6 to 107.9 MHz */
+const uint8_t max_frequency_code = 204;
+
+StationTable::StationTable(size_t capacity) : slots(), stations(), shift(32), unhandled() {
+  size_t size = 1;
+  while (size < capacity) {
+    size *= 2;
+    shift--;
+  }
+  slots.assign(size, Slot{0, 0});
+}
+
+size_t StationTable::probe(uint32_t key) const {
+  // Fibonacci hashing spreads the clustered PI codes of one region
+  size_t mask = slots.size() - 1;
+  size_t i = shift < 32 ? (key * 2654435769u) >> shift : 0;
+  while (slots[i].key != 0 && slots[i].key != key) i = (i + 1) & mask;
+  return i;
+}
+
+void StationTable::grow() {
+  std::vector<Slot> old_slots;
+  old_slots.swap(slots);
+  slots.assign(old_slots.size() * 2, Slot{0, 0});
+  shift--;
+  for (const Slot &slot : old_slots) {
+    if (slot.key != 0) slots[probe(slot.key)] = slot;
+  }
+}
+
+Station &StationTable::find(uint16_t pi) {
+  uint32_t key = pi | slot_used;
+  size_t i = probe(key);
+  if (slots[i].key == key) return stations[slots[i].index];
+
+  // keep the load factor at most 1/2 so probe sequences stay short
+  if ((stations.size() + 1) * 2 > slots.size()) {
+    grow();
+    i = probe(key);
+  }
+  Station station{};
+  station.pi = pi;
+  std::fill(station.ps, station.ps + sizeof(station.ps), '_');
+  std::fill(station.rt, station.rt + sizeof(station.rt), '_');
+  slots[i] = Slot{key, static_cast<uint32_t>(stations.size())};
+  stations.push_back(station);
+  return stations.back();
+}
+
+/**
+ * Decodes one Group Type + Version Code into a station. The primary
+ * template has no handler; specializations below handle their type.
+ */
+template <uint8_t Code> struct GroupDecoder {
+  static const bool handled = false; /**< Whether groups of this type are decoded */
+
+  /**
+   * Updates a station from a group.
+   * @param station The station that sent the group.
+   * @param group The group in A, B, C, D order.
+   */
+  static void decode(Station &, const uint32_t *) {}
+};
+
+/**
+ * Stores the PS segment and flags of a 0A or 0B group.
+ * @param station The station that sent the group.
+ * @param group The group in A, B, C, D order.
+ */
+static void decode_ps(Station &station, const uint32_t *group) {
+  uint32_t segment = Layout0A::Segment::extract(group);
+  station.has_0A = true;
+  station.ta = static_cast<uint8_t>(Layout0A::Ta::extract(group));
+  station.ms = static_cast<uint8_t>(Layout0A::Ms::extract(group));
+  station.ps[segment * 2] = static_cast<char>(Layout0A::Ps1::extract(group));
+  station.ps[segment * 2 + 1] = static_cast<char>(Layout0A::Ps2::extract(group));
+  station.ps_received |= static_cast<uint8_t>(1 << segment);
+}
+
+/**
+ * Prepares the RT buffer of a station for a 2A or 2B group.
+ * @param station The station that sent the group.
+ * @param group The group in A, B, C, D order.
+ * @param length Length of the RT carried by this group type.
+ * @return Segment address of the group.
+ */
+static uint8_t start_rt(Station &station, const uint32_t *group, uint8_t length) {
+  uint8_t ab = static_cast<uint8_t>(Layout2A::Ab::extract(group));
+  // a toggled A/B flag or another version announces a new text
+  if (station.has_2A && (ab != station.ab || length != station.rt_length)) {
+    std::fill(station.rt, station.rt + sizeof(station.rt), '_');
+    station.rt_received = 0;
+  }
+  station.has_2A = true;
+  station.ab = ab;
+  station.rt_length = length;
+  uint8_t segment = static_cast<uint8_t>(Layout2A::Segment::extract(group));
+  station.rt_received |= static_cast<uint16_t>(1 << segment);
+  return segment;
+}
+
+/* Basic tuning and switching information, PS and AF */
+template <> struct GroupDecoder<group_type_code_0A> {
+  static const bool handled = true;
+  static void decode(Station &station, const uint32_t *group) {
+    uint8_t af1 = static_cast<uint8_t>(Layout0A::Af1::extract(group));
+    uint8_t af2 = static_cast<uint8_t>(Layout0A::Af2::extract(group));
+    // groups without an AF pair carry filler codes
+    if (af1 >= 1 && af1 <= max_frequency_code) {
+      station.af1 = af1;
+      station.af2 = af2 >= 1 && af2 <= max_frequency_code ? af2 : 0;
+    }
+    decode_ps(station, group);
+  }
+};
+
+/* Basic tuning and switching information without AF, PI repeated in C' */
+template <> struct GroupDecoder<group_type_code_0B> {
+  static const bool handled = true;
+  static void decode(Station &station, const uint32_t *group) { decode_ps(station, group); }
+};
+
+/* Radio Text, four characters per group */
+template <> struct GroupDecoder<group_type_code_2A> {
+  static const bool handled = true;
+  static void decode(Station &station, const uint32_t *group) {
+    using L = Layout2A;
+    uint8_t segment = start_rt(station, group, 64);
+    station.rt[segment * 4] = static_cast<char>(L::Rt1::extract(group));
+    station.rt[segment * 4 + 1] = static_cast<char>(L::Rt2::extract(group));
+    station.rt[segment * 4 + 2] = static_cast<char>(L::Rt3::extract(group));
+    station.rt[segment * 4 + 3] = static_cast<char>(L::Rt4::extract(group));
+  }
+};
+
+/* Radio Text, two characters per group, PI repeated in C' */
+template <> struct GroupDecoder<group_type_code_2B> {
+  static const bool handled = true;
+  static void decode(Station &station, const uint32_t *group) {
+    using L = Layout2B;
+    uint8_t segment = start_rt(station, group, 32);
+    station.rt[segment * 2] = static_cast<char>(L::Rt1::extract(group));
+    station.rt[segment * 2 + 1] = static_cast<char>(L::Rt2::extract(group));
+  }
+};
+
+/* Clock time and date */
+template <> struct GroupDecoder<group_type_code_4A> {
+  static const bool handled = true;
+  static void decode(Station &station, const uint32_t *group) {
+    using L = Layout4A;
+    station.has_clock = true;
+    station.mjd = (L::MjdHigh::extract(group) << L::MjdLow::width) | L::MjdLow::extract(group);
+    station.hour = static_cast<uint8_t>((L::HourHigh::extract(group) << L::HourLow::width) | L::HourLow::extract(group));
+    station.minute = static_cast<uint8_t>(L::Minute::extract(group));
+    int8_t offset = static_cast<int8_t>(L::Offset::extract(group));
+    station.local_offset = L::OffsetSign::extract(group) ? static_cast<int8_t>(-offset) : offset;
+  }
+};
+
+/** Entry of the dispatch table. */
+struct GroupHandler {
+  void (*decode)(Station &, const uint32_t *); /**< GroupDecoder<Code>::decode */
+  bool handled;                                /**< GroupDecoder<Code>::handled */
+};
+
+/**
+ * Builds the dispatch table with one entry per Group Type + Version Code.
+ * @return The table.
+ */
+template <size_t... Codes> static constexpr std::array<GroupHandler, group_type_codes> make_handlers(std::index_sequence<Codes...>) {
+  return {{GroupHandler{&GroupDecoder<Codes>::decode, GroupDecoder<Codes>::handled}...}};
+}
+
+/* Handler of every Group Type + Version Code */
+static constexpr std::array<GroupHandler, group_type_codes> group_handlers = make_handlers(std::make_index_sequence<group_type_codes>());
+
+void mjd_to_date(uint32_t mjd, unsigned &year, unsigned &month, unsigned &day) {
+  // conversion given in annex G of the RDS standard
+  unsigned y = static_cast<unsigned>((mjd - 15078.2) / 365.25);
+  unsigned m = static_cast<unsigned>((mjd - 14956.1 - static_cast<unsigned>(y * 365.25)) / 30.6001);
+  day = mjd - 14956 - static_cast<unsigned>(y * 365.25) - static_cast<unsigned>(m * 30.6001);
+  unsigned k = (m == 14 || m == 15) ? 1 : 0;
+  year = 1900 + y + k;
+  month = m - 1 - k * 12;
+}
+
+void StationTable::push_group(const uint32_t *group) {
+  Station &station = find(static_cast<uint16_t>(GroupLayout::Pi::extract(group)));
+  station.groups++;
+  station.tp = static_cast<uint8_t>(GroupLayout::Tp::extract(group));
+  station.pty = static_cast<uint8_t>(GroupLayout::Pty::extract(group));
+
+  uint8_t code = get_group_code(group[1]);
+  const GroupHandler &handler = group_handlers[code];
+  if (!handler.handled) {
+    station.unhandled++;
+    unhandled[code]++;
+    return;
+  }
+  handler.decode(station, group);
+}
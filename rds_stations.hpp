@@ -0,0 +1,121 @@
+/**
+ * @file       rds_stations.hpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Per-station state for captures that mix several transmitters
+ *
+ * @date      17 October  2026 \n
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "common.hpp"
+
+/**
+ * Everything received from one station. Characters never received are '_'.
+ * PS comes from 0A and 0B groups, RT from 2A (64 characters) or 2B (32
+ * characters) groups and the clock time from 4A groups.
+ */
+struct Station {
+  uint16_t pi;          /**< Program Identification */
+  uint8_t tp;           /**< Traffic Program flag of the last group */
+  uint8_t pty;          /**< Program Type of the last group */
+  uint8_t ta;           /**< Traffic Announcement flag of the last 0A group */
+  uint8_t ms;           /**< Music/Speech flag of the last 0A group */
+  uint8_t ab;           /**< Radio Text A/B flag of the last 2A group */
+  uint8_t af1;          /**< Last valid Alternative Frequency #1 code, 0 if none */
+  uint8_t af2;          /**< Last valid Alternative Frequency #2 code, 0 if none */
+  uint8_t ps_received;  /**< Bitmask of received PS segments */
+  uint16_t rt_received; /**< Bitmask of received RT segments */
+  uint8_t rt_length;    /**< Length of the RT, 64 for 2A, 32 for 2B */
+  bool has_0A;          /**< Whether a 0A or 0B group has been received */
+  bool has_2A;          /**< Whether a 2A or 2B group has been received */
+  bool has_clock;       /**< Whether a 4A group has been received */
+  uint32_t mjd;         /**< Modified Julian Day of the last 4A group */
+  uint8_t hour;         /**< UTC hour of the last 4A group */
+  uint8_t minute;       /**< UTC minute of the last 4A group */
+  int8_t local_offset;  /**< Local time offset in half hours of the last 4A group */
+  uint32_t groups;      /**< Number of received groups */
+  uint32_t unhandled;   /**< Number of groups of types without a handler */
+  char ps[8];           /**< Program Service name */
+  char rt[64];          /**< Radio Text */
+};
+
+/**
+ * Converts a Modified Julian Day into a calendar date.
+ * @param mjd The Modified Julian Day.
+ * @param year Output year.
+ * @param month Output month, 1-12.
+ * @param day Output day of the month, 1-31.
+ */
+void mjd_to_date(uint32_t mjd, unsigned &year, unsigned &month, unsigned &day);
+
+/**
+ * Routes groups to per-station state by their PI code in a single pass.
+ * Each group is decoded by the handler for its Group Type + Version Code
+ * from a 32-entry table; types without a handler are counted and skipped.
+ *
+ * Stations are kept in order of first appearance; an open-addressing table
+ * with linear probing maps PI codes to them. A slot holds the key next to
+ * the station index, so a lookup usually touches one cache line of the
+ * table and one of the station array.
+ */
+class StationTable {
+public:
+  /**
+   * Constructor for StationTable.
+   * @param capacity Initial number of slots, rounded up to a power of two.
+   */
+  explicit StationTable(size_t capacity = 64);
+
+  /**
+   * Updates the station a group was sent by.
+   * @param group The group in A, B, C, D order.
+   */
+  void push_group(const uint32_t *group);
+
+  /**
+   * Finds a station, adding it if it has not been seen yet.
+   * @param pi Program Identification.
+   * @return The station, valid until the next station is added.
+   */
+  Station &find(uint16_t pi);
+
+  /** Returns the stations in order of first appearance. */
+  const std::vector<Station> &get_stations() const { return stations; }
+
+  /** Returns the number of skipped groups per Group Type + Version Code. */
+  const uint32_t *get_unhandled() const { return unhandled; }
+
+private:
+  /** Entry of the open-addressing table. */
+  struct Slot {
+    uint32_t key;   /**< PI code | slot_used, 0 if the slot is free */
+    uint32_t index; /**< Index of the station in stations */
+  };
+
+  static const uint32_t slot_used = 1 << 16; /**< Marks a used slot, PI 0 is valid */
+
+  /** Doubles the table and reinserts every station. */
+  void grow();
+
+  /**
+   * Finds the slot of a PI code.
+   * @param key PI code | slot_used.
+   * @return Index of the slot holding the key, or of the free slot ending the probe.
+   */
+  size_t probe(uint32_t key) const;
+
+  std::vector<Slot> slots;       /**< Open-addressing table, a power of two in size */
+  std::vector<Station> stations; /**< Stations in order of first appearance */
+  unsigned shift;                /**< 32 - log2(slots.size()) for the hash */
+  uint32_t unhandled[group_type_codes]; /**< Skipped groups per Group Type + Version Code */
+};
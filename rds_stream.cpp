@@ -0,0 +1,342 @@
+/**
+ * @file       rds_stream.cpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Decoding of RDS streams into printed messages and station summaries
+ *
+ * @date      17 October  2026 \n
+ */
+
+#include "rds_stream.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <unistd.h>
+
+#include "rds_demodulator.hpp"
+
+void print_frequency(std::ostream &out, uint32_t frequency) { out << (frequency + 875) / 10 << '.' << (frequency + 875) % 10; }
+
+size_t trim_space_end(const char *text, size_t length) {
+  while (length > 0 && text[length - 1] == ' ') length--;
+  return length;
+}
+
+void print_text(const char *name, const char *text, size_t length) {
+  std::cout << name << ": \"";
+  std::cout.write(text, static_cast<std::streamsize>(trim_space_end(text, length)));
+  std::cout << "\"" << std::endl;
+}
+
+void print_stations(const StationTable &table) {
+  bool first = true;
+  for (const Station &station : table.get_stations()) {
+    if (!first) std::cout << std::endl;
+    first = false;
+    std::cout << "PI: " << station.pi << std::endl;
+    std::cout << "TP: " << (int)station.tp << std::endl;
+    std::cout << "PTY: " << (int)station.pty << std::endl;
+    if (station.has_0A) {
+      std::cout << "TA: " << (station.ta ? "Active" : "Inactive") << std::endl;
+      std::cout << "MS: " << (station.ms ? "Music" : "Speech") << std::endl;
+      if (station.af1) {
+        std::cout << "AF: ";
+        print_frequency(std::cout, station.af1);
+        if (station.af2) {
+          std::cout << ", ";
+          print_frequency(std::cout, station.af2);
+        }
+        std::cout << std::endl;
+      }
+      print_text("PS", station.ps, sizeof(station.ps));
+    }
+    if (station.has_2A) {
+      std::cout << "A/B: " << (int)station.ab << std::endl;
+      // a text ended by a carriage return is shorter than its version allows
+      const char *end = static_cast<const char *>(std::memchr(station.rt, RDS_RT_END, station.rt_length));
+      print_text("RT", station.rt, end ? static_cast<size_t>(end - station.rt) : station.rt_length);
+    }
+    if (station.has_clock) {
+      unsigned year, month, day;
+      mjd_to_date(station.mjd, year, month, day);
+      int offset = station.local_offset < 0 ? -station.local_offset : station.local_offset;
+      std::cout << "CT: " << year << "-" << std::setfill('0') << std::setw(2) << month << "-" << std::setw(2) << day << " "
+                << std::setw(2) << (int)station.hour << ":" << std::setw(2) << (int)station.minute << " UTC, offset "
+                << (station.local_offset < 0 ? "-" : "+") << std::setw(2) << offset / 2 << ":" << (offset % 2 ? "30" : "00")
+                << std::setfill(' ') << std::endl;
+    }
+    std::cout << "Groups: " << station.groups << std::endl;
+  }
+
+  // types without a handler, e.g. "Unhandled: 1A 3, 8A 5"
+  bool any = false;
+  for (uint8_t code = 0; code < group_type_codes; code++) {
+    if (!table.get_unhandled()[code]) continue;
+    char name[4];
+    group_name(code, name);
+    std::cout << (any ? ", " : "\nUnhandled: ") << name << " " << table.get_unhandled()[code];
+    any = true;
+  }
+  if (any) std::cout << std::endl;
+}
+
+int CommonGroup::parse() {
+  int status = rds_assembler_decode(&assembler, &fields);
+  if (status != RDS_OK) {
+    count_metric(METRIC_DECODE_ERRORS);
+    std::cout << rds_status_message(status) << std::endl;
+    return 1;
+  }
+  count_metric(METRIC_MESSAGES);
+  return 0;
+}
+
+void Group2A::print_info() {
+  std::cout << "PI: " << fields.pi << std::endl;
+  std::cout << "GT: " << "2A" << std::endl;
+  std::cout << "TP: " << (int)fields.tp << std::endl;
+  std::cout << "PTY: " << (int)fields.pty << std::endl;
+  std::cout << "A/B: " << (int)fields.ab << std::endl;
+  print_text("RT", fields.rt, std::strlen(fields.rt));
+}
+
+void Group0A::print_info() {
+  std::cout << "PI: " << fields.pi << std::endl;
+  std::cout << "GT: " << "0A" << std::endl;
+  std::cout << "TP: " << (int)fields.tp << std::endl;
+  std::cout << "PTY: " << (int)fields.pty << std::endl;
+  std::cout << "TA: " << (fields.ta ? "Active" : "Inactive") << std::endl;
+  std::cout << "MS: " << (fields.ms ? "Music" : "Speech") << std::endl;
+  std::cout << "DI: " << (int)fields.di << std::endl;
+  std::cout << "AF: ";
+  print_frequency(std::cout, fields.af1);
+  std::cout << ", ";
+  print_frequency(std::cout, fields.af2);
+  std::cout << std::endl;
+  print_text("PS", fields.ps, RDS_PS_LENGTH);
+}
+
+StreamDecoder::StreamDecoder(BitFormat format, unsigned max_bad_blocks, bool correct, StationTable *stations, unsigned sample_rate,
+                             MetricsExporter *exporter, QualityMonitor *monitor)
+    : synchronizer(max_bad_blocks, correct), format(format), sample_rate(sample_rate), reader(), assembler_0A(), assembler_2A(), key_0A(0), key_2A(0), messages(0),
+      skipped(0), stations(stations), exporter(exporter),
+      monitor(monitor) {
+  rds_assembler_init(&assembler_0A);
+  rds_assembler_init(&assembler_2A);
+}
+
+uint32_t message_key(const uint32_t *group, uint32_t segment_mask) {
+  uint32_t pi = GroupLayout::Pi::extract(group);
+  uint32_t flags = (group[1] & inv_crc_mask & ~segment_mask) >> 10;
+  return (pi << 16) | flags;
+}
+
+void StreamDecoder::push_group(const uint32_t *group) {
+  count_group(group);
+  if (stations) {
+    stations->push_group(group);
+    return;
+  }
+  GroupType groupType = get_group(group[1]);
+  if (groupType == UNKNOWN) {
+    skipped++;
+    return;
+  }
+  rds_assembler &assembler = groupType == GROUP_0A ? assembler_0A : assembler_2A;
+  uint32_t &key = groupType == GROUP_0A ? key_0A : key_2A;
+
+  // a different station or a changed flag starts a new message
+  uint32_t group_key = message_key(group, groupType == GROUP_0A ? segment_fields_0A : segment_fields_2A);
+  if (group_key != key) rds_assembler_init(&assembler);
+  key = group_key;
+  rds_assembler_push(&assembler, group);
+  if (!rds_assembler_complete(&assembler)) return;
+
+  StageTimer timer(STAGE_DECODE);
+  if (groupType == GROUP_0A) {
+    Group0A group0A(assembler);
+    if (group0A.parse() == 0) {
+      group0A.print_info();
+      std::cout << std::endl;
+      messages++;
+    }
+  } else {
+    Group2A group2A(assembler);
+    if (group2A.parse() == 0) {
+      group2A.print_info();
+      std::cout << std::endl;
+      messages++;
+    }
+  }
+  rds_assembler_init(&assembler);
+}
+
+void StreamDecoder::feed(uint32_t value, unsigned width) {
+  reader.push(value, width);
+  while (reader.available() > 0) {
+    bool done;
+    if (synchronizer.is_synced()) {
+      if (reader.available() < 26) return;
+      done = synchronizer.push_block(reader.take(26));
+      if (monitor) monitor->advance(26, true);
+    } else {
+      done = synchronizer.push_bit(reader.take(1));
+      if (monitor) monitor->advance(1, false);
+    }
+    if (!done) continue;
+    if (monitor) monitor->push_group(synchronizer.group_valid(), synchronizer.group_corrected());
+    if (synchronizer.group_complete()) push_group(synchronizer.group());
+  }
+}
+
+int StreamDecoder::read_bits(int fd) {
+  char buffer[stream_chunk_size];
+  uint32_t words[stream_chunk_size / 32];
+  for (;;) {
+    if (exporter) exporter->poll();
+    ssize_t length;
+    {
+      StageTimer timer(STAGE_READ);
+      length = read(fd, buffer, sizeof(buffer));
+    }
+    if (length < 0) {
+      if (errno == EINTR) continue;
+      std::cerr << "Read error: " << std::strerror(errno) << std::endl;
+      return 1;
+    }
+    if (length == 0) break;
+
+    StageTimer timer(STAGE_SYNCHRONIZE);
+    if (format == FORMAT_PACKED) {
+      for (ssize_t i = 0; i < length; i++) feed(static_cast<uint8_t>(buffer[i]), 8);
+      continue;
+    }
+    size_t i = 0;
+    while (i < static_cast<size_t>(length)) {
+      // runs of bits are converted 32 characters at a time
+      size_t converted = scan_ascii_bits(buffer + i, static_cast<size_t>(length) - i, words);
+      for (size_t w = 0; w < converted / 32; w++) feed(words[w], 32);
+      i += converted;
+      if (i == static_cast<size_t>(length)) break;
+
+      char c = buffer[i++];
+      if (c == ' ' || c == '\n' || c == '\r' || c == '\t') continue;
+      if (c != '0' && c != '1') {
+        std::cout << "Invalid character in binary value: " << c << std::endl;
+        return 1;
+      }
+      feed(c == '1', 1);
+    }
+  }
+  return 0;
+}
+
+int StreamDecoder::read_samples(int fd) {
+  char buffer[stream_chunk_size];
+  // at most a sample per two bytes, or the I and Q of a cu8 pair
+  std::vector<float> samples(stream_chunk_size / 2);
+  std::vector<float> quadrature(is_iq_format(format) ? stream_chunk_size / 2 : 0);
+  size_t used = 0;
+  bool at_end = false;
+
+  WavFormat wav{sample_rate, 1, 32, true, 0xFFFFFFFF};
+  long header = 0;
+  // fills the buffer, returns false on a read error
+  auto fill = [&]() {
+    if (exporter) exporter->poll();
+    StageTimer timer(STAGE_READ);
+    while (!at_end && used < sizeof(buffer)) {
+      ssize_t length = read(fd, buffer + used, sizeof(buffer) - used);
+      if (length < 0) {
+        if (errno == EINTR) continue;
+        std::cerr << "Read error: " << std::strerror(errno) << std::endl;
+        return false;
+      }
+      if (length == 0) at_end = true;
+      used += static_cast<size_t>(length);
+    }
+    return true;
+  };
+
+  if (format == FORMAT_WAV) {
+    if (!fill()) return 1;
+    header = parse_wav_header(buffer, used, wav);
+    if (header <= 0) {
+      std::cerr << "Invalid WAV header" << std::endl;
+      return 1;
+    }
+    if (wav.sample_rate < min_sample_rate || wav.sample_rate > max_sample_rate) {
+      std::cerr << "Unsupported sample rate: " << wav.sample_rate << " (" << min_sample_rate << " to " << max_sample_rate << ")"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  std::unique_ptr<FmDemodulator> fm;
+  if (is_iq_format(format)) fm.reset(new FmDemodulator(sample_rate));
+  Demodulator demodulator(fm ? fm->get_mpx_rate() : wav.sample_rate);
+  size_t frame = fm ? sample_size(format) : wav.channels * wav.bits / 8;
+  size_t start = static_cast<size_t>(header);
+  // a known length ends the samples before any chunk that follows them
+  uint64_t remaining = wav.data_bytes == 0xFFFFFFFF ? UINT64_MAX : wav.data_bytes;
+  for (;;) {
+    size_t available = static_cast<size_t>(std::min<uint64_t>(used - start, remaining));
+    size_t count = available / frame;
+    const char *data = buffer + start;
+    const float *mpx = samples.data();
+    StageTimer demodulate_timer(STAGE_DEMODULATE);
+    if (fm) {
+      convert_iq(data, count, format, samples.data(), quadrature.data());
+      count = fm->demodulate(samples.data(), quadrature.data(), count);
+      mpx = fm->mpx();
+    } else {
+      for (size_t i = 0; i < count; i++) {
+        // the first channel, the signal is mono
+        if (wav.is_float) {
+          std::memcpy(&samples[i], data + i * frame, sizeof(float));
+        } else {
+          int16_t value;
+          std::memcpy(&value, data + i * frame, sizeof(value));
+          samples[i] = value / 32768.0f;
+        }
+      }
+    }
+    size_t bits = demodulator.demodulate(mpx, count);
+    const uint8_t *recovered = demodulator.bits();
+    {
+      StageTimer synchronize_timer(STAGE_SYNCHRONIZE);
+      for (size_t i = 0; i < bits; i++) feed(recovered[i], 1);
+    }
+
+    start += available / frame * frame;
+    remaining -= available / frame * frame;
+    if (at_end || remaining < frame) break;
+    // a partial frame moves to the front of the buffer
+    std::memmove(buffer, buffer + start, used - start);
+    used -= start;
+    start = 0;
+    if (!fill()) return 1;
+  }
+  return 0;
+}
+
+int StreamDecoder::run(int fd) {
+  int ret = is_signal_format(format) ? read_samples(fd) : read_bits(fd);
+  if (ret != 0) return ret;
+  if (monitor) monitor->finish();
+  if (stations) {
+    print_stations(*stations);
+    return stations->get_stations().empty() ? 2 : 0;
+  }
+  if (skipped) std::cerr << "Skipped " << skipped << " groups of unsupported types" << std::endl;
+  return messages ? 0 : 2;
+}
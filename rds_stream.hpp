@@ -0,0 +1,209 @@
+/**
+ * @file       rds_stream.hpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Decoding of RDS streams into printed messages and station summaries
+ *
+ * @date      17 October  2026 \n
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#include "bitstream.hpp"
+#include "common.hpp"
+#include "rds.h"
+#include "rds_metrics.hpp"
+#include "rds_monitor.hpp"
+#include "rds_stations.hpp"
+#include "rds_sync.hpp"
+
+/**
+ * Prints an AF code as a frequency in MHz, e.g. 105 as 98.0.
+ * @param out The stream.
+ * @param frequency The AF code.
+ */
+void print_frequency(std::ostream &out, uint32_t frequency);
+
+/**
+ * Returns the length of a text without its trailing spaces.
+ * @param text The text.
+ * @param length Length of the text.
+ */
+size_t trim_space_end(const char *text, size_t length);
+
+/**
+ * Prints a line with a quoted text without its trailing spaces, e.g.
+ * PS: "RadioXYZ".
+ * @param name Name of the field.
+ * @param text The text.
+ * @param length Length of the text.
+ */
+void print_text(const char *name, const char *text, size_t length);
+
+/**
+ * Prints a summary of every station, separated by empty lines. Fields of
+ * group types never received from a station are left out. The number of
+ * skipped groups per unhandled type follows the stations.
+ * @param table The stations.
+ */
+void print_stations(const StationTable &table);
+
+/**
+ * Represents common fields shared across different RDS groups.
+ */
+class CommonGroup {
+public:
+  /** Constructor that decodes the groups collected by an assembler. */
+  CommonGroup(const rds_assembler &assembler) : assembler(assembler), fields() {}
+
+  /** Virtual function to print group-specific information. */
+  virtual void print_info() = 0;
+
+  /**
+   * Decodes the collected groups and checks that the fields shared by all of
+   * them agree, printing the first inconsistency found.
+   * @return 0 if all groups are consistent, 1 otherwise
+   */
+  int parse();
+
+protected:
+  const rds_assembler &assembler; /**< Groups by segment address */
+  rds_decoded fields;             /**< Decoded message */
+};
+
+/**
+ * Handles displaying information for Group 2A (Radio Text).
+ */
+class Group2A : public CommonGroup {
+public:
+  /** Constructor initializing with the collected groups. */
+  Group2A(const rds_assembler &assembler) : CommonGroup(assembler) {}
+
+  /** Prints information specific to Group 2A. */
+  void print_info() override;
+};
+
+/**
+ * Handles displaying information for Group 0A.
+ */
+class Group0A : public CommonGroup {
+public:
+  /** Constructor initializing with the collected groups. */
+  Group0A(const rds_assembler &assembler) : CommonGroup(assembler) {}
+
+  /**
+   * @brief Prints the information contained in the Group0A object.
+   * 
+   * This function outputs various fields of the Group0A object to the standard output,
+   * including Program Identification (PI), Group Type (GT), Traffic Program (TP), 
+   * Program Type (PTY), Traffic Announcement (TA), Music/Speech (MS), Decoder Information (DI),
+   * Alternative Frequencies (AF), and Program Service name (PS).
+   */
+  void print_info() override;
+};
+
+/**
+ * Identifies the message a group belongs to by its PI code and the block 2
+ * fields that stay the same in every segment of a message.
+ * @param group The four blocks of the group.
+ * @param segment_mask Mask of the block 2 fields that change from segment
+ *        to segment: the segment address and, in 0A, the DI bit.
+ * @return Key that differs whenever the station or a flag changes
+ */
+uint32_t message_key(const uint32_t *group, uint32_t segment_mask);
+
+/** Block 2 fields of a 0A group that change from segment to segment. */
+const uint32_t segment_fields_0A = Layout0A::Segment::mask | Layout0A::Di::mask;
+
+/** Block 2 fields of a 2A group that change from segment to segment. */
+const uint32_t segment_fields_2A = Layout2A::Segment::mask;
+
+const size_t stream_chunk_size = 65536; /**< Bytes read from the stream at once */
+
+/**
+ * Decodes an unbounded bitstream read in fixed-size chunks. Groups are
+ * collected per segment address and every PS or RT message is printed as
+ * soon as all of its segments have been received, so memory stays bounded
+ * no matter how long the stream runs.
+ */
+class StreamDecoder {
+private:
+  BlockSynchronizer synchronizer; /**< Finds block boundaries */
+  BitFormat format;               /**< Format of the stream */
+  unsigned sample_rate;           /**< Samples per second of an f32 or IQ stream */
+  BitReader reader;               /**< Bits not yet passed to the synchronizer */
+  rds_assembler assembler_0A;     /**< Received 0A groups by segment address */
+  rds_assembler assembler_2A;     /**< Received 2A groups by segment address */
+  uint32_t key_0A;                /**< message_key() of the groups in assembler_0A */
+  uint32_t key_2A;                /**< message_key() of the groups in assembler_2A */
+  unsigned messages;              /**< Number of printed messages */
+  unsigned skipped;               /**< Number of groups of unsupported types */
+  StationTable *stations;         /**< Collects every station instead, if set */
+  MetricsExporter *exporter;      /**< Writes the statistics periodically, if set */
+  QualityMonitor *monitor;        /**< Follows the block error rate, if set */
+
+  /**
+   * Stores one synchronized group and prints a message it completes.
+   * @param group The four blocks of the group.
+   */
+  void push_group(const uint32_t *group);
+
+  /**
+   * Passes received bits to the synchronizer, bit by bit while searching
+   * for sync and a whole block at a time once synced.
+   * @param value The bits, right aligned, first received bit highest.
+   * @param width Number of bits, at most 32.
+   */
+  void feed(uint32_t value, unsigned width);
+
+  /**
+   * Reads a bitstream in ASCII or packed format.
+   * @param fd File descriptor to read from until end of file.
+   * @return 0 on success, 1 on an input error
+   */
+  int read_bits(int fd);
+
+  /**
+   * Reads the multiplex signal in WAV or f32 format, or the FM signal in an
+   * IQ format, and demodulates it.
+   * @param fd File descriptor to read from until end of file.
+   * @return 0 on success, 1 on an input error
+   */
+  int read_samples(int fd);
+
+public:
+  /**
+   * Constructor for StreamDecoder.
+   * @param format Format of the stream.
+   * @param max_bad_blocks Flywheel limit for the synchronizer.
+   * @param correct Repair burst errors in blocks.
+   * @param stations Send every group to its station instead of printing
+   *        messages, the summary is printed at the end of the stream.
+   * @param sample_rate Samples per second in f32 and IQ formats, a WAV header
+   *        carries its own.
+   * @param exporter Polled between chunks to write the statistics
+   *        periodically, if set.
+   * @param monitor Receives every block received, if set.
+   */
+  StreamDecoder(BitFormat format, unsigned max_bad_blocks, bool correct, StationTable *stations = nullptr,
+                unsigned sample_rate = default_sample_rate, MetricsExporter *exporter = nullptr, QualityMonitor *monitor = nullptr);
+
+  /**
+   * Decodes everything that can be read from a file descriptor.
+   * @param fd File descriptor to read from until end of file.
+   * @return 0 if at least one message (or station) was decoded, 1 on an
+   *         input error, 2 if the stream held no complete message
+   */
+  int run(int fd);
+
+  /** Returns the number of printed messages. */
+  unsigned get_messages() const { return messages; }
+};
@@ -0,0 +1,107 @@
+/**
+ * @file       rds_sync.cpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Block synchronizer for unaligned RDS bitstreams
+ *
+ * @date      17 October  2026 \n
+ */
+
+#include "rds_sync.hpp"
+
+#include "rds_metrics.hpp"
+
+BlockSynchronizer::BlockSynchronizer(unsigned max_bad_blocks, bool correct)
+    : max_bad_blocks(max_bad_blocks), correct(correct), reg(0), bit_index(0), synced(false), bit_count(0), position(0), bad_blocks(0), sync_losses(0),
+      candidates(), blocks(), valid(0), corrected(0), received(0) {}
+
+bool BlockSynchronizer::push_bit(uint32_t bit) {
+  reg = ((reg << 1) | (bit & 1)) & block_mask;
+  bit_index++;
+
+  if (synced) {
+    // flywheel, check only at the expected block boundary
+    if (++bit_count < 26) return false;
+    bit_count = 0;
+    return check_block(reg);
+  }
+
+  if (bit_index < 26) return false;
+  BlockOffset offset = get_block_offset(reg);
+  int pos = offset_position[offset];
+  if (pos < 0) return false;
+
+  // blocks ending at the same bit phase are exactly 26 bits apart
+  uint64_t number = bit_index / 26;
+  Candidate &prev = candidates[bit_index % 26];
+  int prev_pos = offset_position[prev.offset];
+  if (prev.present && prev.block_number + 1 == number && (prev_pos + 1) % 4 == pos) {
+    synced = true;
+    bit_count = 0;
+    bad_blocks = 0;
+    valid = 0;
+    corrected = 0;
+    received = 0;
+    // the previous block is part of the same group unless it ended one
+    if (pos != 0) {
+      blocks[prev_pos] = prev.block;
+      valid |= static_cast<uint8_t>(1 << prev_pos);
+      received |= static_cast<uint8_t>(1 << prev_pos);
+      count_block(prev.offset);
+    }
+    position = pos;
+    count_block(offset);
+    return store_block(reg, true, false);
+  }
+  prev.block_number = number;
+  prev.block = reg;
+  prev.offset = offset;
+  prev.present = true;
+  return false;
+}
+
+bool BlockSynchronizer::push_block(uint32_t block) {
+  reg = block & block_mask;
+  bit_index += 26;
+  return check_block(reg);
+}
+
+bool BlockSynchronizer::check_block(uint32_t block) {
+  BlockOffset offset = get_block_offset(block);
+  bool ok = offset_position[offset] == position;
+  bool fixed = !ok && correct && correct_block(block, expected_offset(position, blocks[1]));
+  count_block(offset);
+  if (fixed) count_metric(METRIC_CORRECTED);
+  if (!ok && !fixed) count_metric(METRIC_CRC_FAILURES);
+  bad_blocks = ok ? 0 : bad_blocks + 1;
+  bool done = store_block(block, ok || fixed, fixed);
+  if (bad_blocks >= max_bad_blocks) lose_sync();
+  return done;
+}
+
+bool BlockSynchronizer::store_block(uint32_t block, bool ok, bool fixed) {
+  // a new group starts, forget the previous one
+  if (position == 0) {
+    valid = 0;
+    corrected = 0;
+    received = 0;
+  }
+  blocks[position] = block;
+  received |= static_cast<uint8_t>(1 << position);
+  if (ok) valid |= static_cast<uint8_t>(1 << position);
+  if (fixed) corrected |= static_cast<uint8_t>(1 << position);
+  bool done = position == 3;
+  position = (position + 1) % 4;
+  return done;
+}
+
+void BlockSynchronizer::lose_sync() {
+  synced = false;
+  sync_losses++;
+  count_metric(METRIC_SYNC_LOSSES);
+  for (Candidate &candidate : candidates) candidate.present = false;
+}
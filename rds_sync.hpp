@@ -0,0 +1,125 @@
+/**
+ * @file       rds_sync.hpp
+ *
+ * @author    Pavel Kratochvil \n
+ *            Faculty of Information Technology \n
+ *            Brno University of Technology \n
+ *            xkrato61@fit.vutbr.cz
+ *
+ * @brief     Block synchronizer for unaligned RDS bitstreams
+ *
+ * @date      17 October  2026 \n
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "common.hpp"
+
+const unsigned default_max_bad_blocks = 4; /**< Consecutive bad blocks before sync is lost */
+
+/**
+ * Finds block boundaries in a bitstream fed one bit at a time.
+ *
+ * While unsynchronized, the last 26 bits are checked after every bit. Sync is
+ * acquired once two consecutive blocks, 26 bits apart, carry offset words in
+ * A->B->C->D order. From then on the flywheel checks one block every 26 bits
+ * and keeps lock through bad blocks until max_bad_blocks of them follow each
+ * other, after which it slides bit by bit again. With correction enabled,
+ * bad blocks at a known position are repaired from their syndrome; they are
+ * still counted as bad by the flywheel since a repair does not prove the
+ * alignment.
+ */
+class BlockSynchronizer {
+public:
+  /**
+   * Constructor for BlockSynchronizer.
+   * @param max_bad_blocks Consecutive bad blocks after which sync is lost.
+   * @param correct Repair burst errors in blocks while synced.
+   */
+  explicit BlockSynchronizer(unsigned max_bad_blocks = default_max_bad_blocks, bool correct = false);
+
+  /**
+   * Shifts one bit into the synchronizer.
+   * @param bit The received bit (0 or 1).
+   * @return true if a group has been completed and can be read with group().
+   */
+  bool push_bit(uint32_t bit);
+
+  /**
+   * Passes a whole block to the flywheel. Only allowed while synced, which
+   * always leaves the synchronizer at a block boundary when bits are fed
+   * 26 at a time.
+   * @param block The next 26 received bits.
+   * @return true if a group has been completed and can be read with group().
+   */
+  bool push_block(uint32_t block);
+
+  /** Returns the blocks of the last completed group in A, B, C, D order. */
+  const uint32_t *group() const { return blocks; }
+
+  /** Returns a bitmask of blocks of the last completed group that passed the check. */
+  uint8_t group_valid() const { return valid; }
+
+  /**
+   * Returns a bitmask of blocks of the last completed group that were
+   * received in sync; the blocks before the acquisition were not.
+   */
+  uint8_t group_received() const { return received; }
+
+  /** Returns a bitmask of blocks of the last completed group that were repaired. */
+  uint8_t group_corrected() const { return corrected; }
+
+  /** Returns true if every block of the last completed group passed the check. */
+  bool group_complete() const { return valid == 0xF; }
+
+  /** Returns true while the synchronizer is locked to block boundaries. */
+  bool is_synced() const { return synced; }
+
+  /** Returns how many times an acquired sync has been lost. */
+  unsigned get_sync_losses() const { return sync_losses; }
+
+private:
+  /** Last valid block seen at one bit phase while searching for sync. */
+  struct Candidate {
+    uint64_t block_number; /**< Bit index / 26 at which the block ended */
+    uint32_t block;        /**< Block value */
+    BlockOffset offset;    /**< Offset word of the block */
+    bool present;          /**< Whether the entry holds a block */
+  };
+
+  /**
+   * Stores a checked block at the current flywheel position.
+   * @param block The block value.
+   * @param ok Whether the block carries the expected offset.
+   * @param fixed Whether the block was repaired to get there.
+   * @return true if this block completes a group.
+   */
+  bool store_block(uint32_t block, bool ok, bool fixed);
+
+  /**
+   * Checks the block at the expected boundary while synced.
+   * @param block The block value.
+   * @return true if this block completes a group.
+   */
+  bool check_block(uint32_t block);
+
+  /** Drops the lock and clears the acquisition state. */
+  void lose_sync();
+
+  unsigned max_bad_blocks; /**< Consecutive bad blocks after which sync is lost */
+  bool correct;            /**< Repair burst errors while synced */
+  uint32_t reg;            /**< Last 26 received bits */
+  uint64_t bit_index;      /**< Number of bits received */
+  bool synced;             /**< Locked to block boundaries */
+  unsigned bit_count;      /**< Bits received since the last block boundary */
+  int position;            /**< Position of the next block in its group */
+  unsigned bad_blocks;     /**< Consecutive bad blocks while synced */
+  unsigned sync_losses;    /**< Number of times sync was lost */
+  Candidate candidates[26]; /**< Acquisition state per bit phase */
+  uint32_t blocks[4];      /**< Group being assembled */
+  uint8_t valid;           /**< Bitmask of checked blocks in blocks */
+  uint8_t corrected;       /**< Bitmask of repaired blocks in blocks */
+  uint8_t received;        /**< Bitmask of blocks received in sync in blocks */
+};
@@ -9,10 +9,20 @@
 #
 # @date      23 November  2024 \n 
 
+import ctypes
+import io
+import json
+import math
+import os
+import struct
 import subprocess
+import tempfile
+import wave
 
 ENCODER_PATH = './rds_encoder'
 DECODER_PATH = './rds_decoder'
+LIBRARY_PATH = './librds.so'
+ALLOC_TEST_PATH = './rds_alloc_test'
 
 # [brief, command, expected_result_code, should_check_output, expected_stdout]
 test_encoder_0A = [
@@ -61,8 +71,8 @@ test_encoder_2A = [
   ["basic valid 2A long rt", ["-g", "2A", "-pi", "4660", "-pty", "5", "-tp", "1", "-rt", "Now Playing Song Title by ArtistNow Playing Song Title by Artist", "-ab", "0"], 0, True, "00010010001101000001101010001001001010000011111011100100111001101111100111101101110111001000001100100100000100100011010000011010100010010010100001100101011101010000011011001000101010011000010111100111110101010001001000110100000110101000100100101000100010011100011010010110111010011110010110011100100000000010111100010010001101000001101010001001001010001101001001010101001101101111011000010101101110011001111000001011000100100011010000011010100010010010100100001011001100100000010101001000010010011010010111010001011010110001001000110100000110101000100100101001010100001010011011000110010100000111010010000001100010111001100100010010001101000001101010001001001010011011110000010111100100100000100110100101000001011100100110110010000100100011010000011010100010010010100111100111100001110100011010010000010001011100110111010000100000010001001000110100000110101000100100101010000011101101010011100110111110011110110111011100100000110010010000010010001101000001101010001001001010100101010101000101000001101100100010101001100001011110011111010101000100100011010000011010100010010010101010111001111101101001011011101001111001011001110010000000001011110001001000110100000110101000100100101010111000100110010100110110111101100001010110111001100111100000101100010010001101000001101010001001001010110011101100000010000001010100100001001001101001011101000101101011000100100011010000011010100010010010101101100000100101101100011001010000011101001000000110001011100110010001001000110100000110101000100100101011100011000010011110010010000010011010010100000101110010011011001000010010001101000001101010001001001010111101011110110111010001101001000001000101110011011101000010000001", ""],
   ["basic valid 2A empty rt", ["-g", "2A", "-pi", "4660", "-pty", "5", "-tp", "1", "-rt", "", "-ab", "0"], 0, True, "00010010001101000001101010001001001010000011111011100010000000100000000000000000100000001000000011011100000100100011010000011010100010010010100001100101011100100000001000000000000000001000000010000000110111000001001000110100000110101000100100101000100010011100001000000010000000000000000010000000100000001101110000010010001101000001101010001001001010001101001001010010000000100000000000000000100000001000000011011100000100100011010000011010100010010010100100001011001100100000001000000000000000001000000010000000110111000001001000110100000110101000100100101001010100001010001000000010000000000000000010000000100000001101110000010010001101000001101010001001001010011011110000010010000000100000000000000000100000001000000011011100000100100011010000011010100010010010100111100111100000100000001000000000000000001000000010000000110111000001001000110100000110101000100100101010000011101101001000000010000000000000000010000000100000001101110000010010001101000001101010001001001010100101010101000010000000100000000000000000100000001000000011011100000100100011010000011010100010010010101010111001111100100000001000000000000000001000000010000000110111000001001000110100000110101000100100101010111000100110001000000010000000000000000010000000100000001101110000010010001101000001101010001001001010110011101100000010000000100000000000000000100000001000000011011100000100100011010000011010100010010010101101100000100100100000001000000000000000001000000010000000110111000001001000110100000110101000100100101011100011000010001000000010000000000000000010000000100000001101110000010010001101000001101010001001001010111101011110110010000000100000000000000000100000001000000011011100", ""],
   
-  ["invalid ab", ["-g", "2A", "-pi", "4660", "-pty", "5", "-tp", "1", "-rt", "Now Playing Song Title by Artist", "-ab", "-1"], 1, False, "", ""],
-  ["invalid ab", ["-g", "2A", "-pi", "4660", "-pty", "5", "-tp", "1", "-rt", "Now Playing Song Title by Artist", "-ab", "2"], 1, False, "", ""],
+  ["invalid ab", ["-g", "2A", "-pi", "4660", "-pty", "5", "-tp", "1", "-rt", "Now Playing Song Title by Artist", "-ab", "-1"], 1, False, ""],
+  ["invalid ab", ["-g", "2A", "-pi", "4660", "-pty", "5", "-tp", "1", "-rt", "Now Playing Song Title by Artist", "-ab", "2"], 1, False, ""],
 ]
 
 test_decoder_0A = [
@@ -89,6 +99,591 @@ test_decoder_2A = [
   ["2A swap missing more groups", ["-b", "01001110011011111001111011001001001010000011111011100111011100100000110010010000010010001101000001101010010100000110110010001010100010010010100001100101011100010010001101000001101010011000010111100111110101010110100101101110100111100100100100101000100010011100011001110010000000001011110001001000110100000110101000100100101000110100100101000100100011010000011010100110111001100111100000101101010011011011110110000101011011000110010100000111010010010010100101010000101000100000011000101110011001000100100011010000011010100010010010100110111100000100010010001101000001101010010000010111001001101100100111100100100000100110100100010010001101000001101010001001001010011110011110000111001101110100001000000101110100011010010000010001001001001010100000111011010001001000110100000110101000100000001000000011011100001000000010000000000000000010000000100000001101110000100000001000000000000000001001001010101011100111110001001000110100000110101000100100101010111000100110001000000010000000110111000010000000100000000000000000010010001101000001101010001001001010110011101100000001001000110100000110101000100000001000000011011100001000000010000000000000000010010010101101100000100100100000001000000011011100001000000010000000000000000001001000110100000110101000100100101011110101111011001000000010000000110111000010000000100000000000000000010010001101000001101010"], 0, True, "PI: 4660\nGT: 2A\nTP: 1\nPTY: 5\nA/B: 0\nRT: \"Now Playing Song____le by Artist    ____                ____\"\n"],
 ]
 
+VALID_0A = test_decoder_0A[1][1][1]
+VALID_2A = test_decoder_2A[0][1][1]
+OUTPUT_0A = test_decoder_0A[1][4]
+OUTPUT_2A = test_decoder_2A[0][4]
+
+temp_files = []
+
+def stream_file(content):
+  handle, path = tempfile.mkstemp(suffix='.txt')
+  with os.fdopen(handle, 'w') as f:
+    f.write(content)
+  temp_files.append(path)
+  return path
+
+test_decoder_sync = [
+  ["sync leading and trailing bits", ["--sync", "-b", "101" + VALID_0A + "11"], 0, True, OUTPUT_0A],
+  ["sync start mid block", ["--sync", "-b", VALID_2A[40:] + VALID_2A], 0, True, OUTPUT_2A],
+  ["sync dropped bit", ["--sync", "-b", VALID_0A[:200] + VALID_0A[201:] + VALID_0A], 0, True, OUTPUT_0A],
+  ["sync max bad blocks", ["--sync", "--max-bad", "2", "-b", "0" + VALID_0A], 0, True, OUTPUT_0A],
+  ["sync no group", ["--sync", "-b", "0101"], 2, False, ""],
+  ["sync empty", ["--sync", "-b", ""], 1, False, ""],
+  ["sync invalid character", ["--sync", "-b", "0102"], 1, False, ""],
+  ["sync invalid max bad", ["--sync", "--max-bad", "0", "-b", VALID_0A], 1, False, ""],
+  ["unaligned without sync", ["-b", "0" + VALID_0A], 1, False, ""],
+  ["invalid character reported", ["-b", VALID_0A[:300] + "x" + VALID_0A[301:]], 1, True, "Invalid character in binary value: x\n"],
+  ["invalid character in tail", ["-b", VALID_0A[:-1] + "2"], 1, True, "Invalid character in binary value: 2\n"],
+  ["invalid character in stream", ["--stream", stream_file(VALID_0A[:200] + "\n" + VALID_0A[200:300] + "y")], 1, True, "Invalid character in binary value: y\n"],
+]
+
+def flip(bits, start, length):
+  return bits[:start] + ''.join('1' if b == '0' else '0' for b in bits[start:start + length]) + bits[start + length:]
+
+test_decoder_correct = [
+  ["correct single bit", ["--correct", "-b", flip(VALID_0A, 313, 1)], 0, True, OUTPUT_0A],
+  ["correct 5 bit burst", ["--correct", "-b", flip(VALID_2A, 110, 5)], 0, True, OUTPUT_2A],
+  ["correct burst in every block", ["--correct", "-b", ''.join(flip(VALID_0A[i:i + 26], 7, 4) for i in range(0, 416, 26))], 0, True, OUTPUT_0A],
+  ["uncorrectable group skipped", ["--correct", "-b", flip(VALID_0A, 104 + 60, 9)], 0, True, OUTPUT_0A.replace('"RadioXYZ"', '"Ra__oXYZ"')],
+  ["uncorrectable without correct", ["-b", flip(VALID_0A, 104 + 60, 9)], 2, False, ""],
+  ["all groups uncorrectable", ["--correct", "-b", flip(VALID_0A[:104], 60, 9)], 2, False, ""],
+  ["sync and correct", ["--sync", "--correct", "-b", "11" + VALID_0A[:300] + flip(VALID_0A[300:330], 3, 5) + VALID_0A[330:]], 0, True, OUTPUT_0A],
+  ["sync mid group reports only received blocks", ["--sync", "--correct", "-b", VALID_0A[52:156] + flip(VALID_0A[156:], 60, 9)], 0, False, "",
+   "Uncorrectable block 0 in group 2\n"],
+  ["duplicate block", ["-b", VALID_0A[:26] * 2 + VALID_0A[52:]], 2, False, ""],
+  ["duplicate block skipped", ["--correct", "-b", VALID_0A[:26] * 2 + VALID_0A[52:]], 0, True, OUTPUT_0A.replace('"RadioXYZ"', '"__dioXYZ"').replace('104.5, 98.0', '87.5, 87.5')],
+]
+
+test_decoder_stream = [
+  ["stream file", ["--stream", stream_file(VALID_0A)], 0, True, OUTPUT_0A + "\n"],
+  ["stream lines mid block", ["--stream", stream_file(VALID_2A[30:] + "\n" + VALID_0A + "\n" + VALID_2A + "\n")], 0, True, OUTPUT_0A + "\n" + OUTPUT_2A + "\n"],
+  ["stream correct", ["--stream", stream_file(flip(VALID_0A, 313, 3)), "--correct"], 0, True, OUTPUT_0A + "\n"],
+  ["stream no message", ["--stream", stream_file(VALID_0A[:300])], 2, False, ""],
+  ["stream invalid character", ["--stream", stream_file("0120")], 1, False, ""],
+  ["stream message before error", ["--stream", stream_file(VALID_0A + "2" + VALID_0A)], 1, True, OUTPUT_0A + "\nInvalid character in binary value: 2\n"],
+  ["stream repeated segments", ["--stream", stream_file(VALID_2A[:104 * 5] + VALID_2A)], 0, True, OUTPUT_2A + "\n"],
+  ["stream missing file", ["--stream", "/nonexistent/rds_stream.txt"], 1, False, ""],
+  ["stream with binary string", ["--stream", "-b", VALID_0A], 1, False, ""],
+]
+
+ENCODE_0A = test_encoder_0A[0][1]
+ENCODE_2A = test_encoder_2A[0][1]
+
+# [brief, encoder arguments, decoder arguments, expected_stdout]
+test_roundtrip = [
+  ["ascii 0A", ENCODE_0A, ["--stream"], OUTPUT_0A + "\n"],
+  ["packed 0A", ENCODE_0A + ["--format", "packed"], ["--stream", "--format", "packed"], OUTPUT_0A + "\n"],
+  ["ascii 2A", ENCODE_2A + ["--format", "ascii"], ["--stream", "--format", "ascii"], OUTPUT_2A + "\n"],
+  ["packed 2A", ["--format", "packed"] + ENCODE_2A, ["--stream", "--format", "packed", "--correct"], OUTPUT_2A + "\n"],
+]
+
+def batch_line(args):
+  return ' '.join('"' + arg + '"' if ' ' in arg or arg == '' else arg for arg in args)
+
+ENCODED_0A = test_encoder_0A[0][4]
+ENCODED_2A = test_encoder_2A[0][4]
+ENCODED_2A_EMPTY = test_encoder_2A[2][4]
+
+test_encoder_batch = [
+  ["batch file", ["--batch", stream_file(batch_line(ENCODE_0A) + "\n" + batch_line(ENCODE_2A) + "\n")], 0, True, ENCODED_0A + "\n" + ENCODED_2A + "\n"],
+  ["batch quoted empty rt", ["--batch", stream_file(batch_line(test_encoder_2A[2][1]) + "\n")], 0, True, ENCODED_2A_EMPTY + "\n"],
+  ["batch error keeps going", ["--batch", stream_file(batch_line(ENCODE_0A) + "\n-g 3A\n\n" + batch_line(ENCODE_0A) + "\n")], 1, True, ENCODED_0A + "\n\n\n" + ENCODED_0A + "\n"],
+  ["batch unterminated quote", ["--batch", stream_file('-g 2A -rt "abc\n' + batch_line(ENCODE_2A) + "\n")], 1, True, "\n" + ENCODED_2A + "\n"],
+  ["batch missing group", ["--batch", stream_file("-pi 4660 -pty 5 -tp 1 -ms 0 -ta 1 -af 104.5,98.0\n")], 1, True, "\n"],
+  ["batch flag without value", ["--batch", stream_file("-g\n" + batch_line(ENCODE_0A) + "\n" + batch_line(ENCODE_2A) + " -pi\n" + batch_line(ENCODE_2A) + "\n")], 1, True,
+   "\n" + ENCODED_0A + "\n\n" + ENCODED_2A + "\n"],
+  ["batch missing file", ["--batch", "/nonexistent/rds_batch.txt"], 1, False, ""],
+  ["batch invalid format", ["--batch", "--format", "hex"], 1, False, ""],
+  ["batch packed format rejected", ["--batch", "--format", "packed"], 1, False, ""],
+  ["batch blank lines", ["--batch", stream_file(batch_line(ENCODE_0A) + "\n\n  \t\n" + batch_line(ENCODE_2A) + "\n")], 0, True, ENCODED_0A + "\n\n\n" + ENCODED_2A + "\n"],
+]
+
+def encode(args):
+  return subprocess.run([ENCODER_PATH] + args, stdout=subprocess.PIPE, universal_newlines=True).stdout
+
+ENCODE_2A_NEXT = ENCODE_2A[:8] + ["-rt", "Now Playing Another Song", "-ab", "1"]
+ENCODE_0A_NEXT = ENCODE_0A[:10] + ["-ta", "0"] + ENCODE_0A[12:]
+
+test_encoder_batch += [
+  ["batch station changes", ["--batch", stream_file('\n'.join(batch_line(args) for args in [ENCODE_2A, ENCODE_0A, ENCODE_2A_NEXT, ENCODE_0A_NEXT, ENCODE_2A]) + "\n")],
+   0, True, ''.join(encode(args) + "\n" for args in [ENCODE_2A, ENCODE_0A, ENCODE_2A_NEXT, ENCODE_0A_NEXT, ENCODE_2A])],
+]
+
+STATION = stream_file(batch_line(ENCODE_0A) + "\n" + batch_line(ENCODE_2A) + "\n")
+OUTPUT_STATION = OUTPUT_0A.replace("GT: 0A\n", "").replace("DI: 0\n", "") + "A/B: 0\nRT: \"Now Playing Song Title by Artist\"\n"
+
+test_encoder_carousel = [
+  ["carousel group count", ["--carousel", STATION, "--groups", "3", "--weights", "0A=1,2A=0"], 0, True, ENCODED_0A[:312]],
+  ["carousel mismatched pi", ["--carousel", stream_file(batch_line(ENCODE_0A) + "\n" + batch_line(ENCODE_2A).replace("4660", "1000") + "\n")], 1, True, ""],
+  ["carousel no weights", ["--carousel", STATION, "--weights", "0A=0,2A=0"], 1, True, ""],
+  ["carousel invalid weights", ["--carousel", STATION, "--weights", "4A=1"], 1, True, ""],
+  ["carousel invalid offset", ["--carousel", STATION, "--offset", "32"], 1, True, ""],
+  ["carousel empty station", ["--carousel", stream_file("\n")], 1, True, ""],
+  ["carousel missing file", ["--carousel", "/nonexistent/rds_station.txt"], 1, True, ""],
+  ["carousel update other pi", ["--carousel", STATION, "--updates", stream_file("10 " + batch_line(ENCODE_2A_NEXT).replace("4660", "1000") + "\n")], 1, True, ""],
+  ["carousel update out of order", ["--carousel", STATION, "--updates", stream_file("10 " + batch_line(ENCODE_2A) + "\n5 " + batch_line(ENCODE_2A) + "\n")], 1, True, ""],
+  ["carousel update without group", ["--carousel", STATION, "--updates", stream_file(batch_line(ENCODE_2A) + "\n")], 1, True, ""],
+  ["carousel update unsent message", ["--carousel", STATION, "--weights", "0A=0", "--updates", stream_file("10 " + batch_line(ENCODE_0A_NEXT) + "\n")], 1, True, ""],
+]
+
+# 1000 groups from 12:26:40 UTC last send the clock time at 12:28
+test_roundtrip += [
+  ["carousel stations", ["--carousel", STATION, "--groups", "1000", "--ct", "--start", "1792240000", "--offset", "4"], ["--stream", "--stations"],
+   OUTPUT_STATION + "CT: 2026-10-17 12:28 UTC, offset +02:00\nGroups: 1000\n"],
+  ["carousel updates", ["--carousel", STATION, "--groups", "600", "--updates", stream_file("100 " + batch_line(ENCODE_0A_NEXT) + "\n300 " + batch_line(ENCODE_2A_NEXT) + "\n")],
+   ["--stream", "--stations"], OUTPUT_STATION.replace("TA: Active", "TA: Inactive").replace("A/B: 0\nRT: \"Now Playing Song Title by Artist\"", "A/B: 1\nRT: \"Now Playing Another Song\"") + "Groups: 600\n"],
+  ["carousel packed 2A only", ["--carousel", STATION, "--groups", "64", "--weights", "0A=0,2A=1", "--format", "packed"], ["--stream", "--format", "packed", "--stations"],
+   'PI: 4660\nTP: 1\nPTY: 5\nA/B: 0\nRT: "Now Playing Song Title by Artist"\nGroups: 64\n'],
+]
+
+class Config0A(ctypes.Structure):
+  _fields_ = [("pi", ctypes.c_uint16), ("pty", ctypes.c_uint8), ("tp", ctypes.c_uint8), ("ms", ctypes.c_uint8), ("ta", ctypes.c_uint8),
+              ("af1", ctypes.c_uint8), ("af2", ctypes.c_uint8), ("ps", ctypes.c_char * 8)]
+
+class Config2A(ctypes.Structure):
+  _fields_ = [("pi", ctypes.c_uint16), ("pty", ctypes.c_uint8), ("tp", ctypes.c_uint8), ("ab", ctypes.c_uint8), ("rt", ctypes.c_char * 64)]
+
+class Decoded(ctypes.Structure):
+  _fields_ = [("group_type", ctypes.c_uint8), ("pi", ctypes.c_uint16), ("tp", ctypes.c_uint8), ("pty", ctypes.c_uint8), ("ta", ctypes.c_uint8),
+              ("ms", ctypes.c_uint8), ("di", ctypes.c_uint8), ("af1", ctypes.c_uint8), ("af2", ctypes.c_uint8), ("ab", ctypes.c_uint8),
+              ("ps", ctypes.c_char * 9), ("rt", ctypes.c_char * 65)]
+
+def library_encode(lib, function, config, count):
+  blocks = (ctypes.c_uint32 * count)()
+  text = ctypes.create_string_buffer(count * 26)
+  written = function(ctypes.byref(config), blocks, count)
+  length = lib.rds_blocks_to_ascii(blocks, written, text, count * 26)
+  return text.raw[:length].decode('ascii')
+
+def library_decode(lib, bits, correct=0):
+  blocks = (ctypes.c_uint32 * (len(bits) // 26))()
+  count = ctypes.c_size_t()
+  status = lib.rds_ascii_to_blocks(bits.encode('ascii'), len(bits), blocks, len(blocks), ctypes.byref(count))
+  if status != 0:
+    return lib.rds_status_message(status).decode('ascii')
+  decoded = Decoded()
+  status = lib.rds_decode(blocks, count.value, correct, ctypes.byref(decoded))
+  if status != 0:
+    return lib.rds_status_message(status).decode('ascii')
+  if decoded.group_type == 0:
+    return f'{decoded.pi} {decoded.tp} {decoded.pty} {decoded.ta} {decoded.ms} {decoded.af1} {decoded.af2} {decoded.ps.decode("ascii")}'
+  return f'{decoded.pi} {decoded.tp} {decoded.pty} {decoded.ab} {decoded.rt.decode("ascii").rstrip()}'
+
+def library_sort(lib, bits):
+  blocks = (ctypes.c_uint32 * 4)(*(int(bits[i:i + 26], 2) for i in range(0, 104, 26)))
+  sorted_blocks = (ctypes.c_uint32 * 4)()
+  status = lib.rds_sort_group(blocks, 1, sorted_blocks, None)
+  if status != 0:
+    return lib.rds_status_message(status).decode('ascii')
+  return ''.join(format(block, '026b') for block in sorted_blocks)
+
+# [brief, function taking the loaded library, expected result]
+test_library = [
+  ["encode 0A", lambda lib: library_encode(lib, lib.rds_encode_0a, Config0A(4660, 5, 1, 0, 1, 170, 105, b"RadioXYZ"), 16), ENCODED_0A],
+  ["encode 2A", lambda lib: library_encode(lib, lib.rds_encode_2a, Config2A(4660, 5, 1, 0, b"Now Playing Song Title by Artist".ljust(64)), 64), ENCODED_2A],
+  ["encode one 0A block", lambda lib: format(lib.rds_encode_0a_block(ctypes.byref(Config0A(4660, 5, 1, 0, 1, 170, 105, b"RadioXYZ")), 6), '026b'), ENCODED_0A[156:182]],
+  ["encode one 2A block", lambda lib: format(lib.rds_encode_2a_block(ctypes.byref(Config2A(4660, 5, 1, 0, b"Now Playing Song Title by Artist".ljust(64))), 63), '026b'), ENCODED_2A[-26:]],
+  ["encode small buffer", lambda lib: lib.rds_encode_0a(ctypes.byref(Config0A()), (ctypes.c_uint32 * 15)(), 15), 0],
+  ["decode 0A", lambda lib: library_decode(lib, VALID_0A), "4660 1 5 1 0 170 105 RadioXYZ"],
+  ["decode 2A", lambda lib: library_decode(lib, VALID_2A), "4660 1 5 0 Now Playing Song Title by Artist"],
+  ["decode corrupt", lambda lib: library_decode(lib, flip(VALID_0A, 30, 1)), "Block matches no offset word"],
+  ["decode corrected", lambda lib: library_decode(lib, flip(VALID_0A, 30, 1), 1), "4660 1 5 1 0 170 105 RadioXYZ"],
+  ["decode invalid character", lambda lib: library_decode(lib, VALID_0A[:-1] + "2"), "Invalid character in binary value"],
+]
+
+def library_tester(test_cases):
+  lib = ctypes.CDLL(LIBRARY_PATH)
+  lib.rds_status_message.restype = ctypes.c_char_p
+  for function in [lib.rds_encode_0a, lib.rds_encode_2a, lib.rds_blocks_to_ascii]:
+    function.restype = ctypes.c_size_t
+  lib.rds_blocks_to_ascii.argtypes = [ctypes.c_void_p, ctypes.c_size_t, ctypes.c_char_p, ctypes.c_size_t]
+  lib.rds_ascii_to_blocks.argtypes = [ctypes.c_char_p, ctypes.c_size_t, ctypes.c_void_p, ctypes.c_size_t, ctypes.c_void_p]
+  lib.rds_decode.argtypes = [ctypes.c_void_p, ctypes.c_size_t, ctypes.c_int, ctypes.c_void_p]
+  for function in [lib.rds_encode_0a_block, lib.rds_encode_2a_block]:
+    function.restype = ctypes.c_uint32
+  lib.rds_sort_group.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p]
+  for idx, test_case in enumerate(test_cases):
+    print('Library test #', idx, ' - ', test_case[0], end='')
+    actual = test_case[1](lib)
+    if actual != test_case[2]:
+      print(' - FAIL')
+      print('Expected:')
+      print(test_case[2])
+      print('Actual:')
+      print(actual)
+      continue
+    print(" - PASS")
+
+def encode_batch(lines):
+  result = subprocess.run([ENCODER_PATH, "--batch"], input='\n'.join(lines) + '\n', stdout=subprocess.PIPE, universal_newlines=True)
+  return result.stdout.split('\n')[:-1]
+
+def interleave(records):
+  groups = [[record[i:i + 104] for i in range(0, len(record), 104)] for record in records]
+  return ''.join(g[i] for i in range(max(len(g) for g in groups)) for g in groups if i < len(g))
+
+def station_summary(pi, ps):
+  return f'PI: {pi}\nTP: 0\nPTY: 1\nTA: Inactive\nMS: Music\nAF: 88.0, 90.0\nPS: "{ps}"\nGroups: 4\n'
+
+MIXED = interleave(encode_batch([batch_line(ENCODE_2A[:2] + ["-pi", "1000"] + ENCODE_2A[4:]), batch_line(ENCODE_0A), "-g 0A -pi 0 -pty 1 -tp 0 -ms 1 -ta 0 -af 88.0,90.0 -ps Other"]))
+OUTPUT_MIXED = OUTPUT_2A.replace("PI: 4660\nGT: 2A\n", "PI: 1000\n") + "Groups: 16\n\n" + \
+  OUTPUT_0A.replace("GT: 0A\n", "").replace("DI: 0\n", "") + "Groups: 4\n\n" + station_summary(0, "Other")
+MANY_STATIONS = interleave(encode_batch([f"-g 0A -pi {pi * 217} -pty 1 -tp 0 -ms 1 -ta 0 -af 88.0,90.0 -ps S{pi}" for pi in range(300)]))
+
+OFFSETS = {'A': 252, 'B': 408, 'C': 360, "C'": 848, 'D': 436}
+
+def block_bits(info, offset):
+  reg = info << 10
+  for i in range(25, 9, -1):
+    if reg & (1 << i):
+      reg ^= 0x5B9 << (i - 10)
+  return format((info << 10) | (reg & 0x3FF) ^ OFFSETS[offset], '026b')
+
+def group_bits(pi, code, tp, pty, low, c, d):
+  b = (code << 11) | (tp << 10) | (pty << 5) | low
+  return block_bits(pi, 'A') + block_bits(b, 'B') + block_bits(c, "C'" if code & 1 else 'C') + block_bits(d, 'D')
+
+def chars(text):
+  return (ord(text[0]) << 8) | ord(text[1])
+
+# 0B PS, 2B RT and 4A clock time (MJD 61330 is 2026-10-17, 12:34 UTC, +02:00), then 1A and 8A groups
+OTHER_TYPES = ''.join(group_bits(21845, 1, 0, 9, 0b10000 | s, 21845, chars("Radio 0B"[s * 2:])) for s in range(4)) + \
+  ''.join(group_bits(4660, 5, 1, 5, s, 4660, chars("Short text".ljust(32)[s * 2:])) for s in range(16)) + \
+  group_bits(4660, 8, 1, 5, 61330 >> 15, ((61330 & 0x7FFF) << 1) | (12 >> 4), ((12 & 0xF) << 12) | (34 << 6) | 4) + \
+  group_bits(4660, 2, 1, 5, 0, 0, 0) + group_bits(4660, 16, 1, 5, 0, 0, 0) + group_bits(21845, 16, 0, 9, 0, 0, 0)
+OUTPUT_OTHER_TYPES = 'PI: 21845\nTP: 0\nPTY: 9\nTA: Active\nMS: Speech\nPS: "Radio 0B"\nGroups: 5\n\n' + \
+  'PI: 4660\nTP: 1\nPTY: 5\nA/B: 0\nRT: "Short text"\nCT: 2026-10-17 12:34 UTC, offset +02:00\nGroups: 19\n\nUnhandled: 1A 1, 8A 2\n'
+
+# the last bit of block C' of a 0B group flipped, its syndrome is also that of a burst against offset C
+test_library += [
+  ["sort corrected C'", lambda lib: library_sort(lib, flip(OTHER_TYPES[:104], 52 + 25, 1)), OTHER_TYPES[:104]],
+  ["sort corrected C", lambda lib: library_sort(lib, flip(VALID_0A[:104], 52 + 25, 1)), VALID_0A[:104]],
+  ["sort corrected C' before B", lambda lib: library_sort(lib, OTHER_TYPES[26:52] + OTHER_TYPES[:26] + flip(OTHER_TYPES[52:104], 25, 1)), OTHER_TYPES[:104]],
+  ["sort duplicate block", lambda lib: library_sort(lib, VALID_0A[:26] * 2 + VALID_0A[52:104]), "Two blocks of a group carry the same offset word"],
+  ["decode trailing bits", lambda lib: library_decode(lib, VALID_0A + "01"), "Invalid length of binary value"],
+]
+
+# 0A of a stereo station, DI set only in segment 3 as the standard sends it one bit per segment
+STEREO_0A = ''.join(group_bits(4660, 0, 1, 5, 0b10000 | ((s == 3) << 2) | s, (170 << 8) | 105, chars("RadioXYZ"[s * 2:])) for s in range(4))
+
+test_decoder_stations = [
+  ["stations mixed", ["--stations", "-b", MIXED], 0, True, OUTPUT_MIXED],
+  ["stations stream", ["--stations", "--stream", stream_file(MIXED)], 0, True, OUTPUT_MIXED],
+  ["stations many", ["--stations", "--stream", stream_file(MANY_STATIONS)], 0, True, '\n'.join(station_summary(pi * 217, f"S{pi}") for pi in range(300))],
+  ["mixed without stations", ["-b", MIXED], 1, True, "Inconsistent PI value across blocks\n"],
+  ["stations other group types", ["--stations", "-b", OTHER_TYPES], 0, True, OUTPUT_OTHER_TYPES],
+  ["DI in one segment", ["-b", STEREO_0A], 0, True, OUTPUT_0A],
+  ["stream DI in one segment", ["--stream", stream_file(STEREO_0A)], 0, True, OUTPUT_0A + "\n"],
+  ["stream skips other group types", ["--stream", stream_file(OTHER_TYPES[-104 * 3:] + VALID_0A)], 0, True, OUTPUT_0A + "\n"],
+  ["unsupported groups skipped", ["-b", VALID_0A[:208] + OTHER_TYPES[-104:] + VALID_0A[208:]], 0, True, OUTPUT_0A],
+  ["only unsupported groups", ["-b", OTHER_TYPES[-104 * 3:]], 1, True, "Unsupported group type\n"],
+  ["0B 2B 4A need stations", ["-b", OTHER_TYPES[:104 * 21]], 1, True, "Unsupported group type\n", "Skipped 21 groups of unsupported types\n"],
+  ["stream 0B 2B 4A need stations", ["--stream", stream_file(OTHER_TYPES[:104 * 21])], 2, True, "", "Skipped 21 groups of unsupported types\n"],
+  ["0B 2B 4A skipped without stations", ["-b", OTHER_TYPES[:104 * 21] + VALID_0A], 0, True, OUTPUT_0A, "Skipped 21 groups of unsupported types\n"],
+  ["stations no group", ["--stations", "--stream", stream_file(MIXED[:100])], 2, False, ""],
+]
+
+# RT ended by a carriage return after 11 characters fits into 3 groups
+TRIMMED_RT = "Hello world\r".ljust(64)
+TRIMMED_2A = ''.join(group_bits(4660, 4, 1, 5, s, chars(TRIMMED_RT[s * 4:]), chars(TRIMMED_RT[s * 4 + 2:])) for s in range(3))
+FULL_TRIMMED_2A = ''.join(group_bits(4660, 4, 1, 5, s, chars(TRIMMED_RT[s * 4:]), chars(TRIMMED_RT[s * 4 + 2:])) for s in range(16))
+OUTPUT_TRIMMED = 'PI: 4660\nGT: 2A\nTP: 1\nPTY: 5\nA/B: 0\nRT: "Hello world"\n'
+
+test_encoder_2A += [
+  ["trimmed rt", ["-g", "2A", "-pi", "4660", "-pty", "5", "-tp", "1", "-rt", "Hello world", "-ab", "0", "--trim-rt"], 0, True, TRIMMED_2A],
+  ["trimmed full length rt", ENCODE_2A[:9] + ["Now Playing Song Title by ArtistNow Playing Song Title by Artist"] + ENCODE_2A[10:] + ["--trim-rt"], 0, True, test_encoder_2A[1][4]],
+  ["trimmed rt missing", ["-g", "2A", "-pi", "4660", "-pty", "5", "-tp", "1", "-ab", "0", "--trim-rt"], 1, False, ""],
+  ["trimmed rt with 0A", ENCODE_0A + ["--trim-rt"], 0, True, ENCODED_0A],
+]
+test_decoder_2A += [
+  ["trimmed rt", ["-b", TRIMMED_2A], 0, True, OUTPUT_TRIMMED],
+  ["rt end in full message", ["-b", FULL_TRIMMED_2A], 0, True, OUTPUT_TRIMMED],
+]
+test_decoder_stream += [
+  ["trimmed rt complete early", ["--stream", stream_file(TRIMMED_2A + TRIMMED_2A[:104])], 0, True, OUTPUT_TRIMMED + "\n"],
+]
+test_decoder_stations += [
+  ["stations trimmed rt", ["--stations", "--stream", stream_file(FULL_TRIMMED_2A)], 0, True, OUTPUT_TRIMMED.replace("GT: 2A\n", "") + "Groups: 16\n"],
+]
+test_roundtrip += [
+  ["trimmed rt", ENCODE_2A + ["--trim-rt"], ["--stream"], OUTPUT_2A + "\n"],
+]
+test_library += [
+  ["encode 2A trimmed", lambda lib: library_encode(lib, lib.rds_encode_2a, Config2A(4660, 5, 1, 0, TRIMMED_RT.encode("ascii")), 64), TRIMMED_2A],
+]
+
+def wav_info(data):
+  with wave.open(io.BytesIO(data)) as w:
+    return (w.getframerate(), w.getnchannels(), w.getsampwidth(), w.getnframes())
+
+def wav_bits(data, count):
+  # coherent 57 kHz demodulation, biphase decision per bit and differential decoding
+  rate = struct.unpack('<I', data[24:28])[0]
+  samples = struct.unpack('<%dh' % ((len(data) - 44) // 2), data[44:])
+  per_bit = rate / 1187.5
+  start = math.ceil(2 * per_bit)
+  half = int(per_bit / 2)
+  mixed = [x * math.cos(2 * math.pi * 57000 * i / rate) for i, x in enumerate(samples)]
+  bits, previous = '', 0
+  for k in range(count):
+    center = start + (k + 0.5) * per_bit
+    level = sum(mixed[int(center - per_bit / 2) + j] for j in range(half)) - sum(mixed[int(center) + j] for j in range(half))
+    symbol = 1 if level > 0 else 0
+    bits += str(symbol ^ previous)
+    previous = symbol
+  return bits
+
+# [brief, encoder arguments, output to a pipe instead of a file, function of the result code and output, expected]
+test_waveform = [
+  # 192 samples per bit at 228 kHz, the last symbol reaches 384 samples past the center of its bit
+  ["wav 0A header", ENCODE_0A + ["--wav"], False, lambda code, out: (code, wav_info(out)), (0, (228000, 1, 2, 415 * 192 + 96 + 769))],
+  ["wav stream header", ENCODE_0A + ["--wav"], True, lambda code, out: (out[:4], out[4:8], out[40:44], len(out)), (b"RIFF", b"\xff" * 4, b"\xff" * 4, 44 + 2 * (415 * 192 + 96 + 769))],
+  ["wav 0A bits", ENCODE_0A + ["--format", "wav"], True, lambda code, out: wav_bits(out, 416), ENCODED_0A],
+  ["wav 2A bits at 192 kHz", ENCODE_2A + ["--wav", "--rate", "192000", "--trim-rt"], False, lambda code, out: wav_bits(out, 104 * 9), encode(ENCODE_2A + ["--trim-rt"])],
+  ["wav carousel", ["--carousel", STATION, "--groups", "20", "--wav"], False, lambda code, out: wav_bits(out, 2080), encode(["--carousel", STATION, "--groups", "20"])],
+  ["wav invalid rate", ENCODE_0A + ["--wav", "--rate", "48000"], True, lambda code, out: (code, out), (1, b"")],
+  ["cu8 constant envelope", ENCODE_0A + ["--format", "cu8"], True,
+   lambda code, out: (len(out), max(abs(math.hypot(out[i] - 127.5, out[i + 1] - 127.5) - 127.5) for i in range(0, len(out), 2)) < 1),
+   (2 * (415 * 192 + 96 + 769), True)],
+]
+
+def noisy(data, snr, rate):
+  # white noise at snr dB below the signal, the header claims a sample rate off by the clock error
+  random = __import__('random').Random(1)
+  samples = struct.unpack('<%dh' % ((len(data) - 44) // 2), data[44:])
+  sigma = math.sqrt(sum(x * x for x in samples) / len(samples) / 10 ** (snr / 10))
+  noisy_samples = [max(-32768, min(32767, int(x + random.gauss(0, sigma)))) for x in samples]
+  return data[:24] + struct.pack('<I', rate) + data[28:44] + struct.pack('<%dh' % len(samples), *noisy_samples)
+
+def without_groups(code, out):
+  # groups sent before the demodulator locks are lost, the count varies
+  return (code, ''.join(line + '\n' for line in out.decode('utf-8').splitlines() if not line.startswith('Groups: ')))
+
+# [brief, encoder arguments, transformation of the signal or None, decoder arguments, function of the result code and output, expected]
+test_demodulation = [
+  ["wav carousel stations", ["--carousel", STATION, "--groups", "100", "--wav"], None, ["--stream", "--format", "wav", "--stations"], without_groups,
+   (0, OUTPUT_STATION)],
+  ["wav 0A messages", ["--carousel", STATION, "--groups", "12", "--weights", "0A=1,2A=0", "--wav"], None, ["--stream", "--format", "wav"],
+   lambda code, out: (code, out.decode('utf-8').split('\n\n')[0] + '\n'), (0, OUTPUT_0A)],
+  ["wav 2A at 192 kHz", ["--carousel", STATION, "--groups", "40", "--weights", "0A=0,2A=1", "--wav", "--rate", "192000"], None,
+   ["--stream", "--format", "wav", "--stations"], without_groups, (0, 'PI: 4660\nTP: 1\nPTY: 5\nA/B: 0\nRT: "Now Playing Song Title by Artist"\n')],
+  ["f32 at 250 kHz", ["--carousel", STATION, "--groups", "100", "--format", "f32", "--rate", "250000"], None,
+   ["--stream", "--format", "f32", "--rate", "250000", "--stations"], without_groups, (0, OUTPUT_STATION)],
+  ["wav noise and clock error", ["--carousel", STATION, "--groups", "60", "--wav"], lambda data: noisy(data, 5, 228050),
+   ["--stream", "--format", "wav", "--stations", "--correct"], without_groups, (0, OUTPUT_STATION)],
+  ["wav invalid header", ENCODE_0A, None, ["--stream", "--format", "wav"], lambda code, out: (code, out), (1, b"")],
+  ["wav unsupported rate", ENCODE_0A + ["--wav"], lambda data: data[:24] + struct.pack('<I', 48000) + data[28:], ["--stream", "--format", "wav"],
+   lambda code, out: (code, out), (1, b"")],
+  ["f32 invalid rate", ENCODE_0A + ["--format", "f32"], None, ["--stream", "--format", "f32", "--rate", "44100"], lambda code, out: code, 1],
+  ["cu8 at 2.4 MHz", ["--carousel", STATION, "--groups", "40", "--format", "cu8", "--rate", "2400000"], None,
+   ["--stream", "--format", "cu8", "--rate", "2400000", "--stations"], without_groups, (0, OUTPUT_STATION)],
+  ["cs16 at 1.024 MHz", ["--carousel", STATION, "--groups", "40", "--format", "cs16", "--rate", "1024000"], None,
+   ["--stream", "--format", "cs16", "--rate", "1024000", "--stations"], without_groups, (0, OUTPUT_STATION)],
+  ["cf32 at 240 kHz", ["--carousel", STATION, "--groups", "40", "--format", "cf32", "--rate", "240000"], None,
+   ["--stream", "--format", "cf32", "--rate", "240000", "--stations"], without_groups, (0, OUTPUT_STATION)],
+  ["cu8 invalid rate", ENCODE_0A + ["--format", "cu8"], None, ["--stream", "--format", "cu8", "--rate", "4000000"], lambda code, out: code, 1],
+]
+
+def demodulation_tester(test_cases):
+  for idx, test_case in enumerate(test_cases):
+    print('Demodulation test #', idx, ' - ', test_case[0], end='')
+    signal = subprocess.run([ENCODER_PATH] + test_case[1], stdout=subprocess.PIPE, stderr=subprocess.PIPE).stdout
+    if test_case[2]:
+      signal = test_case[2](signal)
+    decoded = subprocess.run([DECODER_PATH] + test_case[3], input=signal, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    actual = test_case[4](decoded.returncode, decoded.stdout)
+    if actual != test_case[5]:
+      print(' - FAIL')
+      print('Expected:')
+      print(test_case[5])
+      print('Actual:')
+      print(actual)
+      continue
+    print(" - PASS")
+
+def score(truth, decoded):
+  # groups per station sent, sent undamaged and decoded, and decoded groups of stations never sent
+  sent = {}
+  for line in truth.splitlines():
+    fields = line.split()
+    if fields[0] == 'T':
+      sent[int(fields[1])] = [int(fields[2]), int(fields[3]), 0]
+  spurious = 0
+  pi = None
+  for line in decoded.decode('utf-8').splitlines():
+    if line.startswith('PI: '):
+      pi = int(line[4:])
+    elif line.startswith('Groups: '):
+      if pi in sent:
+        sent[pi][2] = int(line[8:])
+      else:
+        spurious += int(line[8:])
+  return sent, spurious
+
+def recovered(ratio):
+  # every station decodes at least ratio of its undamaged groups, no more than it sent
+  return lambda sent, spurious: all(ratio * intact <= got <= total for total, intact, got in sent.values())
+
+CAPTURE = ["--capture", "--groups", "3000", "--stations", "3", "--dwell", "200"]
+
+# [brief, encoder arguments, decoder arguments, function of the score, expected]
+test_capture = [
+  ["clean channel decodes every group", CAPTURE, ["--stream", "--stations"],
+   lambda sent, spurious: (all(total == intact == got for total, intact, got in sent.values()), len(sent), spurious), (True, 3, 0)],
+  ["bit errors and bursts", CAPTURE + ["--ber", "0.001", "--bursts", "0.0002", "--burst-length", "8"], ["--stream", "--stations", "--correct"],
+   recovered(0.95), True],
+  ["slips and dropouts", CAPTURE + ["--slips", "0.00005", "--dropouts", "0.00002"], ["--stream", "--stations", "--correct"],
+   recovered(0.9), True],
+  ["packed with every impairment", CAPTURE + ["--ber", "0.0005", "--bursts", "0.0001", "--slips", "0.00002", "--dropouts", "0.00001",
+   "--format", "packed", "--seed", "7"], ["--stream", "--format", "packed", "--stations", "--correct"], recovered(0.9), True],
+  ["many stations, short visits", ["--capture", "--groups", "3000", "--stations", "50", "--dwell", "20"], ["--stream", "--stations"],
+   lambda sent, spurious: (len(sent), sum(total for total, intact, got in sent.values()), all(total == got for total, intact, got in sent.values())),
+   (50, 3000, True)],
+]
+
+def capture_tester(test_cases):
+  for idx, test_case in enumerate(test_cases):
+    print('Capture test #', idx, ' - ', test_case[0], end='')
+    truth_path = stream_file('')
+    capture = subprocess.run([ENCODER_PATH] + test_case[1] + ["--truth", truth_path], stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    decoded = subprocess.run([DECODER_PATH] + test_case[2], input=capture.stdout, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    with open(truth_path) as f:
+      truth = f.read()
+    actual = test_case[3](*score(truth, decoded.stdout)) if capture.returncode == 0 else capture.returncode
+    if actual != test_case[4]:
+      print(' - FAIL')
+      print('Expected:')
+      print(test_case[4])
+      print('Actual:')
+      print(actual)
+      continue
+    print(" - PASS")
+
+def capture_invalid_tester():
+  # the same seed gives the same capture, invalid options fail
+  first = subprocess.run([ENCODER_PATH] + CAPTURE + ["--ber", "0.01", "--slips", "0.001"], stdout=subprocess.PIPE).stdout
+  second = subprocess.run([ENCODER_PATH] + CAPTURE + ["--ber", "0.01", "--slips", "0.001"], stdout=subprocess.PIPE).stdout
+  other = subprocess.run([ENCODER_PATH] + CAPTURE + ["--ber", "0.01", "--slips", "0.001", "--seed", "2"], stdout=subprocess.PIPE).stdout
+  codes = [subprocess.run([ENCODER_PATH] + CAPTURE + args, stdout=subprocess.PIPE, stderr=subprocess.PIPE).returncode
+           for args in [["--ber", "0.6"], ["--ber", "x"], ["--stations", "0"], ["--stations", "1001"], ["--dwell", "0"], ["--groups", "0"]]]
+  for brief, passed in [["same seed, same capture", first == second and first != other], ["invalid options", codes == [1] * 6]]:
+    print('Capture test - ', brief, ' - PASS' if passed else ' - FAIL')
+
+# [brief, decoder arguments, stdin, expected exit code, function of the metrics file, expected]
+test_metrics = [
+  ["json after -b", test_decoder_0A[1][1],
+   None, 0, lambda m: (json.loads(m)["blocks"], json.loads(m)["groups"], json.loads(m)["unique_pis"], json.loads(m)["messages"]),
+   (16, {"0A": 4}, 1, 1)],
+  ["prometheus from a stream", ["--stream", "--correct", "--metrics-format", "prometheus"],
+   "CAPTURE", 0, lambda m: [line.split()[0] for line in m.splitlines() if line.startswith("rds_blocks_total") or line.startswith("rds_groups_total")],
+   ["rds_blocks_total", "rds_groups_total{type=\"0A\"}", "rds_groups_total{type=\"2A\"}", "rds_groups_total{type=\"4A\"}"]],
+  ["stream with an interval", ["--stream", "--metrics-interval", "1"],
+   "CAPTURE", 0, lambda m: (json.loads(m)["blocks"], json.loads(m)["crc_failures"], json.loads(m)["sync_losses"]), (12000, 0, 0)],
+  ["sync found at a group start", ["--stream", stream_file(VALID_0A[78:] + VALID_0A)], None, 0, lambda m: json.loads(m)["blocks"], 28],
+  ["unknown format", ["-b", "0", "--metrics-format", "xml"], None, 1, None, None],
+  ["interval without --stream", ["-b", "0", "--metrics-interval", "1"], None, 1, None, None],
+]
+
+def metrics_tester(test_cases):
+  capture = subprocess.run([ENCODER_PATH] + CAPTURE, stdout=subprocess.PIPE).stdout
+  for idx, test_case in enumerate(test_cases):
+    print('Metrics test #', idx, ' - ', test_case[0], end='')
+    metrics_path = stream_file('')
+    decoded = subprocess.run([DECODER_PATH] + test_case[1] + ["--metrics", metrics_path], input=capture if test_case[2] else None,
+                             stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    with open(metrics_path) as f:
+      metrics = f.read()
+    actual = decoded.returncode
+    if actual == test_case[3] and test_case[4]:
+      actual = test_case[4](metrics)
+    if actual != (test_case[5] if test_case[4] else test_case[3]):
+      print(' - FAIL')
+      print('Expected:')
+      print(test_case[5] if test_case[4] else test_case[3])
+      print('Actual:')
+      print(actual)
+      continue
+    print(" - PASS")
+
+def status_lines(out):
+  return [line.split() for line in out.decode('utf-8').splitlines() if line.startswith('[') and ' BLER ' in line]
+
+# [brief, encoder arguments, decoder arguments, function of the exit code, stdout and stderr, expected]
+test_monitor = [
+  ["status lines of a clean capture", CAPTURE, ["--stream", "--monitor", "60"],
+   lambda code, out, err: (code, [line[0] for line in status_lines(out)], all(line[3] == line[5] == line[7] == '0.00%' for line in status_lines(out))),
+   (0, ["[00:01:00]", "[00:02:00]", "[00:03:00]", "[00:04:00]", "[00:04:22]"], True)],
+  ["dropouts raise and clear alerts", CAPTURE + ["--ber", "0.002", "--dropouts", "0.00002", "--dropout-length", "3000"],
+   ["--stream", "--stations", "--correct", "--alert-bler", "10"],
+   lambda code, out, err: (code, status_lines(out), [line[1] for line in status_lines(err)][:2]), (0, [], ["ALERT", "CLEAR"])],
+  ["no alert below the threshold", CAPTURE + ["--ber", "0.001"], ["--stream", "--correct", "--monitor", "120", "--alert-bler", "20"],
+   lambda code, out, err: (len(status_lines(out)), status_lines(err)), (3, [])],
+  ["invalid interval", [], ["--stream", "--monitor", "0"], lambda code, out, err: code, 1],
+  ["invalid threshold", [], ["--stream", "--alert-bler", "101"], lambda code, out, err: code, 1],
+  ["--monitor without --stream", [], ["-b", "0", "--monitor", "10"], lambda code, out, err: code, 1],
+]
+
+def monitor_tester(test_cases):
+  for idx, test_case in enumerate(test_cases):
+    print('Monitor test #', idx, ' - ', test_case[0], end='')
+    capture = subprocess.run([ENCODER_PATH] + test_case[1], stdout=subprocess.PIPE).stdout if test_case[1] else b''
+    decoded = subprocess.run([DECODER_PATH] + test_case[2], input=capture, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    actual = test_case[3](decoded.returncode, decoded.stdout, decoded.stderr)
+    if actual != test_case[4]:
+      print(' - FAIL')
+      print('Expected:')
+      print(test_case[4])
+      print('Actual:')
+      print(actual)
+      continue
+    print(" - PASS")
+
+# [brief, arguments]
+test_allocations = [
+  ["default capture", []],
+  ["one station", ["--stations", "1", "--messages", "200"]],
+  ["many stations", ["--stations", "300", "--messages", "4"]],
+]
+
+def allocation_tester(test_cases):
+  # the decode path must not allocate once the station table has grown
+  for idx, test_case in enumerate(test_cases):
+    print('Allocation test #', idx, ' - ', test_case[0], end='')
+    result = subprocess.run([ALLOC_TEST_PATH] + test_case[1], stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    if result.returncode != 0:
+      print(' - FAIL')
+      print(result.stdout.decode('utf-8'), end='')
+      continue
+    print(" - PASS")
+
+def waveform_tester(test_cases):
+  for idx, test_case in enumerate(test_cases):
+    print('Waveform test #', idx, ' - ', test_case[0], end='')
+    if test_case[2]:
+      result = subprocess.run([ENCODER_PATH] + test_case[1], stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+      code, output = result.returncode, result.stdout
+    else:
+      with tempfile.TemporaryFile() as f:
+        code = subprocess.run([ENCODER_PATH] + test_case[1], stdout=f, stderr=subprocess.PIPE).returncode
+        f.seek(0)
+        output = f.read()
+    actual = test_case[3](code, output)
+    if actual != test_case[4]:
+      print(' - FAIL')
+      print('Expected:')
+      print(test_case[4])
+      print('Actual:')
+      print(actual)
+      continue
+    print(" - PASS")
+
+def roundtrip_tester(test_cases):
+  for idx, test_case in enumerate(test_cases):
+    print('Roundtrip test #', idx, ' - ', test_case[0], end='')
+    encoded = subprocess.run([ENCODER_PATH] + test_case[1], stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    decoded = subprocess.run([DECODER_PATH] + test_case[2], input=encoded.stdout, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    actual_stdout = decoded.stdout.decode('utf-8')
+    if encoded.returncode != 0 or decoded.returncode != 0 or actual_stdout != test_case[3]:
+      print(' - FAIL')
+      print('Encoder result code: ', encoded.returncode, ', decoder result code: ', decoded.returncode)
+      print('Expected:')
+      print(test_case[3])
+      print('Actual:')
+      print(actual_stdout)
+      continue
+    print(" - PASS")
+
 def tester(path, test_cases):
   for idx, test_case in enumerate(test_cases):
     print('Decoder test #', idx, ' - ', test_case[0], end='')
@@ -116,6 +711,15 @@ def tester(path, test_cases):
       print(expected_stdout)
       print('Actual:')
       print(actual_stdout)
+    # an optional sixth entry is the expected stderr
+    if len(test_case) > 5 and test_case[5] != run_result.stderr.decode('utf-8'):
+      print(' - FAIL')
+      print('Unexpected stderr.')
+      print('command: ', ' '.join(command))
+      print('Expected:')
+      print(test_case[5])
+      print('Actual:')
+      print(run_result.stderr.decode('utf-8'))
     print(" - PASS")
 
 
@@ -124,10 +728,41 @@ def main():
   tester(ENCODER_PATH, test_encoder_0A)
   print('------ ENCODER 2A ------')
   tester(ENCODER_PATH, test_encoder_2A)
+  print('------ ENCODER BATCH ------')
+  tester(ENCODER_PATH, test_encoder_batch)
+  print('------ ENCODER CAROUSEL ------')
+  tester(ENCODER_PATH, test_encoder_carousel)
   print('------ DECODER 0A ------')
   tester(DECODER_PATH, test_decoder_0A)
   print('------ DECODER 2A ------')
   tester(DECODER_PATH, test_decoder_2A)
+  print('------ DECODER SYNC ------')
+  tester(DECODER_PATH, test_decoder_sync)
+  print('------ DECODER CORRECTION ------')
+  tester(DECODER_PATH, test_decoder_correct)
+  print('------ DECODER STREAM ------')
+  tester(DECODER_PATH, test_decoder_stream)
+  print('------ DECODER STATIONS ------')
+  tester(DECODER_PATH, test_decoder_stations)
+  print('------ ROUNDTRIP ------')
+  roundtrip_tester(test_roundtrip)
+  print('------ WAVEFORM ------')
+  waveform_tester(test_waveform)
+  print('------ DEMODULATION ------')
+  demodulation_tester(test_demodulation)
+  print('------ CAPTURE ------')
+  capture_tester(test_capture)
+  capture_invalid_tester()
+  print('------ METRICS ------')
+  metrics_tester(test_metrics)
+  print('------ MONITOR ------')
+  monitor_tester(test_monitor)
+  print('------ ALLOCATIONS ------')
+  allocation_tester(test_allocations)
+  print('------ LIBRARY ------')
+  library_tester(test_library)
+  for path in temp_files:
+    os.remove(path)
 
 if __name__ == '__main__':
   main()